@@ -0,0 +1,460 @@
+// Benchmark - measures the performance of the simulation and its building blocks, to track regressions.
+//
+// Usage: Benchmark [results.json] [--quick] [--threads=N]
+// Measured:
+// - the Future Event List backends: hold operations (pop the next event and schedule a new one) and
+//   fill-then-drain, at several numbers of pending events,
+// - the random variates: RandomStream, BufferedRandomStream, and the per-call std::random_device/std::mt19937
+//   generators that the first version of the model used (exponentialDist and normalDist),
+// - the entity bookkeeping: EntityStore and EntityQueue operations,
+// - the whole simulation of the reference plant (without trace): events/sec and replications/sec at
+//   several simulation lengths, on one thread and on all cores with ReplicationRunner,
+// - a simulation of a longer line of stations split over logical processes (ParallelEngine.h): replications/sec
+//   on 1, 2 and 4 threads per simulation.
+//
+// The results are printed as a table and written (by default to Benchmark.json) as a JSON object with a
+// list of measurements {group, name, parameters, metric, value}, so that files of different versions can
+// be compared. With --quick, every measurement runs for a shorter time (less precise).
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <memory>
+#include <cstdlib> // std::atoi
+
+#include "EntityStore.h"
+#include "FutureEventList.h"
+#include "ModelParameters.h"
+#include "PlantModel.h"
+#include "RandomStream.h"
+#include "ReplicationRunner.h"
+#include "Simulation.h"
+
+using namespace std;
+
+// One result of the benchmark
+struct Measurement {
+	string group;      // What is measured: "fel", "variates", "entities" or "simulation"
+	string name;       // Variant measured (e.g. the FEL backend)
+	string parameters; // Size of the problem (e.g. "pending=256"), empty if none
+	string metric;     // Unit of the value (e.g. "ops_per_sec")
+	double value;
+};
+
+// Minimum time of every measurement (secs), set by --quick
+double minimumTime = 0.5;
+
+// Results of the calls to measure are added here, so that the compiler cannot skip the work measured
+volatile double sink = 0;
+
+// Time 'batch' calls to 'body' repeatedly (at least minimumTime) and return the number of calls per second
+double callsPerSecond(const function<double(long)> &body, long batch)
+{
+	typedef chrono::steady_clock Clock;
+
+	// Warm up the caches and the branch predictors
+	sink = sink + body(batch);
+
+	long calls = 0;
+	double elapsed = 0;
+	Clock::time_point start = Clock::now();
+	while (elapsed < minimumTime) {
+		sink = sink + body(batch);
+		calls += batch;
+		elapsed = chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	return calls / elapsed;
+}
+
+// Escape a string for JSON (the strings written here only need quotes and backslashes escaped)
+string jsonString(const string &s)
+{
+	string escaped = "\"";
+	for (size_t i = 0; i < s.size(); ++i) {
+		if (s[i] == '"' || s[i] == '\\')
+			escaped += '\\';
+		escaped += s[i];
+	}
+	return escaped + "\"";
+}
+
+/* Future Event List */
+
+// Every backend at every number of pending events
+void measureFEL(vector<Measurement> &results)
+{
+	const FELType backends[] = { FEL_BINARY_HEAP, FEL_QUATERNARY_HEAP, FEL_PAIRING_HEAP, FEL_CALENDAR_QUEUE };
+	const size_t sizes[] = { 16, 256, 4096, 65536 };
+
+	// Precomputed exponential increments, so that the random numbers are not measured
+	RandomStream stream(1, 0, 0);
+	vector<double> increments(1 << 16);
+	for (size_t i = 0; i < increments.size(); ++i)
+		increments[i] = stream.exponential(5);
+	const size_t mask = increments.size() - 1;
+
+	for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); ++b) {
+		for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+			size_t n = sizes[s];
+			unique_ptr<FutureEventList> fel = createFutureEventList(backends[b]);
+			string parameters = "pending=" + to_string(n);
+
+			// Hold model: the FEL keeps n events, every operation pops the next one and schedules another
+			for (size_t i = 0; i < n; ++i)
+				fel->insert(Event(EVENT_ARRIVAL, increments[i & mask], static_cast<uint32_t>(i)));
+
+			size_t next = n;
+			double holds = callsPerSecond([&](long count) {
+				// Restart the sequence numbers now and then, so that they never wrap around
+				if (next > (1 << 22)) {
+					vector<Event> pending = fel->pendingEvents();
+					fel->clear();
+					for (size_t i = 0; i < pending.size(); ++i)
+						fel->insert(pending[i]);
+					next = n;
+				}
+
+				double last = 0;
+				for (long i = 0; i < count; ++i) {
+					Event event = fel->popNext();
+					last = event.getTimeOfEvent();
+					event.setTimeOfEvent(last + increments[next++ & mask]);
+					fel->insert(event);
+				}
+				return last;
+			}, 10000);
+			results.push_back(Measurement{ "fel", felTypeToString(backends[b]), parameters, "holds_per_sec", holds });
+
+			// Fill then drain: insert n events and pop them all (one operation is one insert and one pop)
+			fel->clear();
+			double fillDrain = callsPerSecond([&](long count) {
+				double last = 0;
+				for (long round = 0; round < count; round += static_cast<long>(n)) {
+					fel->clear();
+					for (size_t i = 0; i < n; ++i)
+						fel->insert(Event(EVENT_ARRIVAL, increments[(round + i) & mask] * 100, static_cast<uint32_t>(i)));
+					while (!fel->empty())
+						last = fel->popNext().getTimeOfEvent();
+				}
+				return last;
+			}, static_cast<long>(n < 10000 ? 10000 / n * n : n));
+			results.push_back(Measurement{ "fel", felTypeToString(backends[b]), parameters, "insert_pop_per_sec", fillDrain });
+		}
+	}
+}
+
+/* Random variates */
+
+// The generators of the first version of the model: a new random_device and mt19937 for every sample
+double legacyExponential(double mu)
+{
+	std::random_device rd;
+	std::exponential_distribution<> rng(1 / mu);
+	std::mt19937 rnd_gen(rd());
+	return rng(rnd_gen);
+}
+
+double legacyNormal(double mean, double sigma)
+{
+	std::random_device rd;
+	std::normal_distribution<double> distribution(mean, sigma);
+	std::mt19937 rnd_gen(rd());
+	return distribution(rnd_gen);
+}
+
+void addVariate(vector<Measurement> &results, const string &name, const function<double(long)> &body, long batch)
+{
+	double rate = callsPerSecond(body, batch);
+	results.push_back(Measurement{ "variates", name, "", "ns_per_variate", 1e9 / rate });
+}
+
+void measureVariates(vector<Measurement> &results)
+{
+	RandomStream stream(1, 0, 0);
+	Distribution service(DIST_NORMAL, 5, 3);
+
+	addVariate(results, "RandomStream::uniform", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += stream.uniform();
+		return sum;
+	}, 100000);
+	addVariate(results, "RandomStream::exponential", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += stream.exponential(5);
+		return sum;
+	}, 100000);
+	addVariate(results, "RandomStream::normal", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += stream.normal(5, 3);
+		return sum;
+	}, 100000);
+	addVariate(results, "RandomStream::bernoulli", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += stream.bernoulli(0.9);
+		return sum;
+	}, 100000);
+	addVariate(results, "Distribution::sample(normal)", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += service.sample(stream);
+		return sum;
+	}, 100000);
+
+	// The same variates from a buffer refilled in blocks
+	BufferedRandomStream buffered;
+	buffered.reseed(1, 0, 0);
+
+	addVariate(results, "BufferedRandomStream::uniform", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += buffered.uniform();
+		return sum;
+	}, 100000);
+	addVariate(results, "BufferedRandomStream::exponential", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += buffered.exponential(5);
+		return sum;
+	}, 100000);
+	addVariate(results, "BufferedRandomStream::normal", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += buffered.normal(5, 3);
+		return sum;
+	}, 100000);
+	addVariate(results, "BufferedRandomStream::bernoulli", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += buffered.bernoulli(0.9);
+		return sum;
+	}, 100000);
+
+	// The legacy generators read the system's entropy source on every call, so they are far slower
+	addVariate(results, "legacy exponentialDist", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += legacyExponential(5);
+		return sum;
+	}, 1000);
+	addVariate(results, "legacy normalDist", [&](long count) {
+		double sum = 0;
+		for (long i = 0; i < count; ++i)
+			sum += legacyNormal(5, 3);
+		return sum;
+	}, 1000);
+}
+
+/* Entity bookkeeping */
+
+void measureEntities(vector<Measurement> &results)
+{
+	const size_t sizes[] = { 16, 4096 };
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		size_t n = sizes[s];
+		string parameters = "live=" + to_string(n);
+
+		// Lifecycle of an Assembly entity: created, visits three stations through their queues, released
+		EntityStore store;
+		EntityQueue queue;
+		for (size_t i = 0; i < n; ++i)
+			queue.push(store.create(0));
+
+		double lifecycles = callsPerSecond([&](long count) {
+			double sum = 0;
+			for (long i = 0; i < count; ++i) {
+				EntityHandle handle = store.create(static_cast<double>(i));
+				for (uint16_t station = 0; station < 3; ++station) {
+					store.visit(handle, station, static_cast<double>(i));
+					queue.push(handle);
+					handle = queue.front();
+					queue.pop();
+				}
+				sum += store[handle].creationTime;
+				store.release(handle);
+			}
+			return sum;
+		}, 100000);
+		results.push_back(Measurement{ "entities", "create-visit-queue-release", parameters, "ns_per_entity", 1e9 / lifecycles });
+	}
+}
+
+/* Whole simulation */
+
+void measureSimulation(vector<Measurement> &results, unsigned numThreads)
+{
+	const double horizons[] = { 1080, 10800, 108000 };
+
+	SimulationOptions options;
+	options.traceLevel = TRACE_NONE;
+
+	for (size_t h = 0; h < sizeof(horizons) / sizeof(horizons[0]); ++h) {
+		ModelParameters params;
+		params.endSimulationTime = horizons[h];
+		params.rampUpTime = horizons[h] / 10;
+		string parameters = "horizon=" + to_string(static_cast<long>(horizons[h]));
+
+		// One thread: replications run one after the other
+		Simulation simulation(params, options);
+		unsigned long long events = 0;
+		int replication = 0;
+		double replicationsPerSec = callsPerSecond([&](long count) {
+			double sum = 0;
+			for (long i = 0; i < count; ++i) {
+				ReplicationOutput output = simulation.run(replication++);
+				events += output.numEvents;
+				sum += output.result.averageTimeInSystem;
+			}
+			return sum;
+		}, 1);
+		double eventsPerReplication = static_cast<double>(events) / replication;
+
+		results.push_back(Measurement{ "simulation", "reference plant", parameters, "events_per_replication", eventsPerReplication });
+		results.push_back(Measurement{ "simulation", "reference plant", parameters, "replications_per_sec", replicationsPerSec });
+		results.push_back(Measurement{ "simulation", "reference plant", parameters, "events_per_sec", replicationsPerSec * eventsPerReplication });
+
+		// All cores: batches of replications through ReplicationRunner
+		ReplicationRunner runner(numThreads);
+		int batch = 4 * static_cast<int>(runner.numThreads());
+		int first = 0;
+		double parallelPerSec = callsPerSecond([&](long count) {
+			double sum = 0;
+			runner.run(params, options, first, static_cast<int>(count), [&](ReplicationOutput &output) {
+				sum += output.result.averageTimeInSystem;
+			});
+			first += static_cast<int>(count);
+			return sum;
+		}, batch);
+
+		results.push_back(Measurement{ "simulation", "reference plant, " + to_string(runner.numThreads()) + " threads", parameters,
+			"replications_per_sec", parallelPerSec });
+	}
+}
+
+// A line of stations in series after the kitting of the reference plant, with service times of at least 1 min
+// so that a simulation can be split over logical processes (see line_plant.txt)
+PlantModel linePlant(int numStations)
+{
+	PlantModel model = referencePlant(ModelParameters());
+	model.stations.clear();
+	for (int s = 0; s < numStations; ++s) {
+		Station station;
+		station.name = "Station " + to_string(s + 1);
+		station.service = Distribution(DIST_NORMAL, 4, 1, 1);
+		if (s + 1 < numStations)
+			station.routes.push_back(Route(s + 1, 1));
+		model.stations.push_back(station);
+	}
+	model.kitStation = 0;
+	model.assemblyStation = 0;
+	model.reworkStation = -1;
+	model.assignStreams();
+	return model;
+}
+
+void measureLogicalProcesses(vector<Measurement> &results)
+{
+	const int numStations = 8;
+	const int processCounts[] = { 1, 2, 4 };
+
+	ModelParameters params;
+	params.plantModel = make_shared<PlantModel>(linePlant(numStations));
+	params.endSimulationTime = 10800;
+	params.rampUpTime = 1080;
+	string parameters = "stations=" + to_string(numStations);
+
+	for (size_t k = 0; k < sizeof(processCounts) / sizeof(processCounts[0]); ++k) {
+		SimulationOptions options;
+		options.traceLevel = TRACE_NONE;
+		options.logicalProcesses = processCounts[k];
+		Simulation simulation(params, options);
+		int replication = 0;
+		double replicationsPerSec = callsPerSecond([&](long count) {
+			double sum = 0;
+			for (long i = 0; i < count; ++i)
+				sum += simulation.run(replication++).result.averageTimeInSystem;
+			return sum;
+		}, 1);
+
+		results.push_back(Measurement{ "simulation", "line plant, " + to_string(simulation.logicalProcesses()) + " logical processes",
+			parameters, "replications_per_sec", replicationsPerSec });
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	string outputPath = "Benchmark.json";
+	unsigned numThreads = 0;
+
+	// Read the command line
+	int positional = 0;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--quick")
+			minimumTime = 0.05;
+		else if (arg.compare(0, 10, "--threads=") == 0)
+			numThreads = static_cast<unsigned>(atoi(arg.c_str() + 10));
+		else if (positional == 0 && arg.compare(0, 2, "--") != 0) {
+			outputPath = arg;
+			positional++;
+		}
+		else
+			positional = -1;
+	}
+
+	if (positional < 0) {
+		cout << "Usage: Benchmark [results.json] [--quick] [--threads=N]" << endl;
+		return 1;
+	}
+
+	vector<Measurement> results;
+	measureFEL(results);
+	measureVariates(results);
+	measureEntities(results);
+	measureSimulation(results, numThreads);
+	measureLogicalProcesses(results);
+
+	// Print the results as a table
+	cout << left << setw(12) << "Group" << setw(38) << "Name" << setw(18) << "Parameters" << setw(24) << "Metric" << "Value" << endl;
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Measurement &m = results[i];
+		cout << left << setw(12) << m.group << setw(38) << m.name << setw(18) << m.parameters << setw(24) << m.metric
+			<< setprecision(6) << m.value << endl;
+	}
+
+	// Write the JSON file
+	ofstream out(outputPath.c_str(), ios::out);
+	if (!out) {
+		cout << "Error, cannot create " << outputPath << endl;
+		return 1;
+	}
+
+	out << "{" << endl;
+	out << "  \"benchmark\": \"Discrete-Event-SYSEN5200\"," << endl;
+	out << "  \"minimumTime\": " << minimumTime << "," << endl;
+	out << "  \"measurements\": [" << endl;
+	out << setprecision(10);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Measurement &m = results[i];
+		out << "    {\"group\": " << jsonString(m.group) << ", \"name\": " << jsonString(m.name)
+			<< ", \"parameters\": " << jsonString(m.parameters) << ", \"metric\": " << jsonString(m.metric)
+			<< ", \"value\": " << m.value << "}" << (i + 1 < results.size() ? "," : "") << endl;
+	}
+	out << "  ]" << endl;
+	out << "}" << endl;
+
+	cout << "Wrote " << results.size() << " measurements to " << outputPath << endl;
+
+	return 0;
+}
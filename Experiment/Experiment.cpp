@@ -0,0 +1,215 @@
+// Experiment - runs a parameter sweep (design of experiments) of the plant model without rebuilding.
+//
+// Usage: Experiment <experiment file> [results.csv] [summary.csv] [--threads=N] [--cache=FILE]
+// The experiment file lists the model inputs that vary (a full factorial grid or a Latin hypercube
+// design) and those that are fixed; see ExperimentDesign.h for the format. All other inputs keep the
+// values of ModelParameters.cpp. Every scenario is checked before any is run: a value out of the range of its
+// input, or a plant that cannot be simulated, rejects the file. Every replication of every scenario is run in
+// parallel on all cores.
+//
+// Two files are written (by default Experiment_Results.csv and Experiment_Summary.csv): the statistics
+// of interest of every replication of every scenario, and their mean and confidence interval per scenario,
+// with the quantiles of the time in system of all its replications (empty with the MSER-5 warm-up).
+// Scenarios use the same master seed, so they are compared with common random numbers.
+//
+// With 'select' in the experiment file, the tool picks the best scenario for one statistic instead, with
+// the KN or OCBA procedure (see RankingSelection.h): it runs a few replications of every scenario, then
+// more of those that are hard to tell apart from the best. The summary has a "Selected" column.
+//
+// With --cache, the results of every replication are also kept in a results cache file (see ResultsCache.h),
+// and the replications already in it are not run again: after a change of some scenarios of the experiment,
+// only the new ones are run, and an interrupted experiment goes on where it stopped. The files written are the same.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib> // std::atoi
+
+#include "ExperimentDesign.h"
+#include "ModelParameters.h"
+#include "OutputAnalysis.h"
+#include "ReplicationRunner.h"
+#include "ResultsCache.h"
+
+using namespace std;
+
+// Confidence level of the confidence intervals in the summary
+double const confidenceLevel = 0.95;
+
+int main(int argc, char *argv[])
+{
+	string experimentPath;
+	string resultsPath = "Experiment_Results.csv";
+	string summaryPath = "Experiment_Summary.csv";
+	unsigned numThreads = 0;
+	string cachePath;
+
+	// Read the command line
+	int positional = 0;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg.compare(0, 10, "--threads=") == 0)
+			numThreads = static_cast<unsigned>(atoi(arg.c_str() + 10));
+		else if (arg.compare(0, 8, "--cache=") == 0)
+			cachePath = arg.substr(8);
+		else if (positional == 0) {
+			experimentPath = arg;
+			positional++;
+		}
+		else if (positional == 1) {
+			resultsPath = arg;
+			positional++;
+		}
+		else if (positional == 2) {
+			summaryPath = arg;
+			positional++;
+		}
+		else
+			positional = -1;
+	}
+
+	if (positional < 1) {
+		cout << "Usage: Experiment <experiment file> [results.csv] [summary.csv] [--threads=N] [--cache=FILE]" << endl;
+		return 1;
+	}
+
+	Experiment experiment;
+	string error;
+	if (!loadExperiment(experimentPath, experiment, error)) {
+		cout << "Error, " << error << endl;
+		return 1;
+	}
+
+	// Every scenario is checked before any is run
+	ModelParameters base;
+	vector<vector<double> > points = designPoints(experiment);
+	vector<ModelParameters> scenarios;
+	if (!buildScenarios(experiment, base, scenarios, error)) {
+		cout << "Error, " << experimentPath << ": " << error << endl;
+		return 1;
+	}
+
+	ofstream results(resultsPath.c_str(), ios::out);
+	ofstream summary(summaryPath.c_str(), ios::out);
+	if (!results || !summary) {
+		cout << "Error, cannot create " << resultsPath << " or " << summaryPath << endl;
+		return 1;
+	}
+
+	// Headers: the scenario, the factors, then the statistics of interest
+	results << "Scenario";
+	summary << "Scenario";
+	for (size_t f = 0; f < experiment.factors.size(); ++f) {
+		results << "," << experiment.factors[f].name;
+		summary << "," << experiment.factors[f].name;
+	}
+	results << "," << "Simulation Number";
+	summary << "," << "Replications";
+	for (int m = 0; m < NUM_METRICS; ++m) {
+		string name = metricToString(static_cast<ResultMetric>(m));
+		results << "," << name;
+		summary << "," << name << " (Mean)" << "," << name << " (Half-Width)";
+	}
+	summary << "," << "Time in System p50" << "," << "Time in System p90" << "," << "Time in System p99";
+	results << "," << "Warm-up Time" << endl;
+	if (experiment.select)
+		summary << "," << "Selected";
+	summary << endl;
+
+	SimulationOptions options;
+	options.traceLevel = TRACE_NONE;
+
+	// Statistics of interest of every scenario
+	vector<ReplicationStatistics> statistics;
+	for (size_t s = 0; s < scenarios.size(); ++s)
+		statistics.push_back(ReplicationStatistics(scenarios[s].antitheticPairs ? 2 : 1));
+
+	int remaining = static_cast<int>(scenarios.size());
+	ReplicationRunner runner(numThreads);
+	cout << "Running " << scenarios.size() << " scenarios on " << runner.numThreads() << " threads" << endl;
+
+	// Replications in the results cache are not run again
+	ResultsCache cache;
+	if (!cachePath.empty()) {
+		if (!cache.open(cachePath, error)) {
+			cout << "Error, " << error << endl;
+			return 1;
+		}
+		cout << cache.size() << " replications in " << cachePath << endl;
+		runner.setCache(&cache);
+	}
+
+	// Write the summary of a scenario
+	vector<int> replications(scenarios.size(), 0);
+	auto writeSummary = [&](size_t s) {
+		summary << s + 1;
+		for (size_t f = 0; f < points[s].size(); ++f)
+			summary << "," << points[s][f];
+		summary << "," << replications[s];
+		for (int m = 0; m < NUM_METRICS; ++m) {
+			const RunningStatistics &metric = statistics[s][static_cast<ResultMetric>(m)];
+			summary << "," << metric.mean() << "," << metric.halfWidth(confidenceLevel);
+		}
+		// Empty cells if the time in system was not recorded (MSER-5 warm-up)
+		const QuantileSketch &timeInSystem = statistics[s].timeInSystemDistribution();
+		if (timeInSystem.empty())
+			summary << ",,,";
+		else
+			summary << "," << timeInSystem.quantile(0.5) << "," << timeInSystem.quantile(0.9) << "," << timeInSystem.quantile(0.99);
+	};
+
+	// Write the statistics of interest of a replication
+	ScenarioConsumer consume = [&](int s, ReplicationOutput &output) {
+		const ReplicationResult &result = output.result;
+
+		results << s + 1;
+		for (size_t f = 0; f < points[s].size(); ++f)
+			results << "," << points[s][f];
+		results << "," << result.simulationNumber;
+		for (int m = 0; m < NUM_METRICS; ++m)
+			results << "," << metricValue(result, static_cast<ResultMetric>(m));
+		results << "," << result.warmUpTime << endl;
+
+		statistics[s].add(result);
+		replications[s]++;
+	};
+
+	if (experiment.select) {
+
+		// Ranking and selection: replications are added where they help to find the best scenario, and the
+		// summary of every scenario is written at the end, with the scenario selected
+		SelectionResult selection = selectBest(runner, scenarios, options, experiment.selection, consume);
+		for (size_t s = 0; s < scenarios.size(); ++s) {
+			writeSummary(s);
+			summary << "," << (static_cast<int>(s) == selection.best ? 1 : 0) << endl;
+		}
+
+		int fixedReplications = 0;
+		for (size_t s = 0; s < scenarios.size(); ++s)
+			fixedReplications += scenarios[s].numSimulations;
+		cout << "Selected scenario " << selection.best + 1 << " (" << metricToString(experiment.selection.metric) << " " <<
+			selection.means[selection.best] << ") after " << selection.replicationsRun << " replications (" <<
+			fixedReplications << " with numSimulations of every scenario), probability of correct selection " <<
+			selection.probabilityCorrect << endl;
+		remaining = 0;
+	}
+	else {
+
+		// Every replication of every scenario. Outputs come back in order of scenario and replication.
+		runner.runScenarios(scenarios, options, [&](int s, ReplicationOutput &output) {
+			consume(s, output);
+
+			// Write the summary of a scenario after its last replication
+			if (output.result.simulationNumber == scenarios[s].numSimulations) {
+				writeSummary(s);
+				summary << endl;
+				remaining--;
+			}
+		});
+	}
+
+	cout << "Wrote " << scenarios.size() - remaining << " scenarios to " << resultsPath << " and " << summaryPath << endl;
+
+	return 0;
+}
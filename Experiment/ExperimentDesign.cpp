@@ -0,0 +1,308 @@
+// Definition of the experiment designs of the Experiment tool.
+
+#include <fstream>
+#include <sstream>
+#include <algorithm> // std::swap
+
+// Include header file for the experiment designs
+#include "ExperimentDesign.h"
+#include "RandomStream.h"
+#include "PlantModel.h"
+
+// Returns true if the name is a model input that can be set by name
+static bool isParameter(const std::string &name)
+{
+	ModelParameters params;
+	double value;
+	return getParameter(params, name, value);
+}
+
+// Names of the statistics of interest in experiment files, in the order of ResultMetric
+static const char *const metricNames[NUM_METRICS] = {
+	"created", "delivered", "timeInSystem", "numInSystem", "assemblyBusy", "reworkBusy"
+};
+
+// Read an experiment file
+bool loadExperiment(const std::string &path, Experiment &experiment, std::string &error)
+{
+	std::ifstream file(path.c_str());
+	if (!file) {
+		error = "cannot open " + path;
+		return false;
+	}
+
+	experiment = Experiment();
+	bool hasLevels = false;
+	bool hasRanges = false;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+
+		// Remove comments
+		std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream words(line);
+		std::string keyword;
+		if (!(words >> keyword))
+			continue; // Blank line
+
+		std::ostringstream where;
+		where << path << ", line " << lineNumber << ": ";
+
+		if (keyword == "design") {
+			std::string type;
+			words >> type;
+			if (type == "grid")
+				experiment.design = DESIGN_GRID;
+			else if (type == "lhs")
+				experiment.design = DESIGN_LATIN_HYPERCUBE;
+			else {
+				error = where.str() + "unknown design '" + type + "' (use grid or lhs)";
+				return false;
+			}
+		}
+		else if (keyword == "points") {
+			if (!(words >> experiment.points) || experiment.points < 1) {
+				error = where.str() + "expected a positive number of points";
+				return false;
+			}
+		}
+		else if (keyword == "seed") {
+			if (!(words >> experiment.seed)) {
+				error = where.str() + "expected a seed";
+				return false;
+			}
+		}
+		else if (keyword == "select") {
+			std::string name, direction;
+			words >> name >> direction;
+			int metric = 0;
+			while (metric < NUM_METRICS && name != metricNames[metric])
+				metric++;
+			if (metric == NUM_METRICS) {
+				error = where.str() + "unknown statistic '" + name + "'";
+				return false;
+			}
+			if (direction != "min" && direction != "max") {
+				error = where.str() + "expected min or max after '" + name + "'";
+				return false;
+			}
+			experiment.select = true;
+			experiment.selection.metric = static_cast<ResultMetric>(metric);
+			experiment.selection.maximize = (direction == "max");
+		}
+		else if (keyword == "procedure") {
+			std::string type;
+			words >> type;
+			SelectionSettings &selection = experiment.selection;
+			if (type == "kn") {
+				selection.procedure = SELECTION_KN;
+				if (!(words >> selection.confidence >> selection.indifferenceZone) || selection.confidence <= 0 ||
+					selection.confidence >= 1 || selection.indifferenceZone <= 0) {
+					error = where.str() + "expected a probability of correct selection and a positive indifference zone";
+					return false;
+				}
+			}
+			else if (type == "ocba") {
+				selection.procedure = SELECTION_OCBA;
+				if (!(words >> selection.budget >> selection.increment) || selection.budget < 1 || selection.increment < 1) {
+					error = where.str() + "expected a positive budget and increment";
+					return false;
+				}
+			}
+			else {
+				error = where.str() + "unknown procedure '" + type + "' (use kn or ocba)";
+				return false;
+			}
+		}
+		else if (keyword == "initial") {
+			if (!(words >> experiment.selection.initialObservations) || experiment.selection.initialObservations < 2) {
+				error = where.str() + "expected at least 2 initial observations";
+				return false;
+			}
+		}
+		else if (keyword == "set" || keyword == "levels" || keyword == "range") {
+			std::string name;
+			words >> name;
+			if (!isParameter(name)) {
+				error = where.str() + "unknown model input '" + name + "'";
+				return false;
+			}
+
+			std::vector<double> values;
+			double value;
+			while (words >> value)
+				values.push_back(value);
+			if (!words.eof()) {
+				error = where.str() + "expected numbers after '" + name + "'";
+				return false;
+			}
+
+			// Every value must be accepted by the input. The points of a range lie between its ends.
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				ModelParameters params;
+				std::string rangeError;
+				if (!setParameter(params, name, values[i], rangeError)) {
+					error = where.str() + rangeError;
+					return false;
+				}
+			}
+
+			if (keyword == "set") {
+				if (values.size() != 1) {
+					error = where.str() + "expected one value for '" + name + "'";
+					return false;
+				}
+				experiment.fixed.push_back(std::make_pair(name, values[0]));
+				continue;
+			}
+
+			Factor factor;
+			factor.name = name;
+			factor.low = 0;
+			factor.high = 0;
+			if (keyword == "levels") {
+				if (values.empty()) {
+					error = where.str() + "expected at least one level for '" + name + "'";
+					return false;
+				}
+				factor.levels = values;
+				hasLevels = true;
+			}
+			else {
+				if (values.size() != 2 || values[1] < values[0]) {
+					error = where.str() + "expected a low and a high value for '" + name + "'";
+					return false;
+				}
+				factor.low = values[0];
+				factor.high = values[1];
+				hasRanges = true;
+			}
+			experiment.factors.push_back(factor);
+		}
+		else {
+			error = where.str() + "unknown keyword '" + keyword + "'";
+			return false;
+		}
+	}
+
+	// Check that the factors match the design
+	if (experiment.design == DESIGN_GRID && hasRanges) {
+		error = path + ": a grid design takes 'levels', not 'range'";
+		return false;
+	}
+	if (experiment.design == DESIGN_LATIN_HYPERCUBE) {
+		if (hasLevels) {
+			error = path + ": a Latin hypercube design takes 'range', not 'levels'";
+			return false;
+		}
+		if (experiment.points < 1) {
+			error = path + ": a Latin hypercube design needs 'points'";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Every combination of the levels of the factors. The last factor varies fastest.
+static std::vector<std::vector<double> > gridPoints(const Experiment &experiment)
+{
+	std::vector<std::vector<double> > points(1);
+	for (std::size_t f = 0; f < experiment.factors.size(); ++f) {
+		const std::vector<double> &levels = experiment.factors[f].levels;
+
+		std::vector<std::vector<double> > expanded;
+		expanded.reserve(points.size() * levels.size());
+		for (std::size_t p = 0; p < points.size(); ++p) {
+			for (std::size_t l = 0; l < levels.size(); ++l) {
+				expanded.push_back(points[p]);
+				expanded.back().push_back(levels[l]);
+			}
+		}
+		points.swap(expanded);
+	}
+
+	return points;
+}
+
+// Latin hypercube sample: the range of each factor is split in n strata of equal width, and each
+// stratum is used by exactly one scenario, at a uniform random position within the stratum. The strata
+// are assigned to scenarios by an independent random permutation per factor. Factor f draws from the
+// Philox stream (seed, f), so the design is the same on every machine.
+static std::vector<std::vector<double> > latinHypercubePoints(const Experiment &experiment)
+{
+	int n = experiment.points;
+	std::vector<std::vector<double> > points(n);
+
+	for (std::size_t f = 0; f < experiment.factors.size(); ++f) {
+		const Factor &factor = experiment.factors[f];
+		RandomStream stream(experiment.seed, static_cast<std::uint32_t>(f), 0);
+
+		// Random permutation of the strata (Fisher-Yates shuffle)
+		std::vector<int> strata(n);
+		for (int i = 0; i < n; ++i)
+			strata[i] = i;
+		for (int i = n - 1; i > 0; --i) {
+			int j = static_cast<int>(stream.uniform() * (i + 1));
+			std::swap(strata[i], strata[j]);
+		}
+
+		for (int i = 0; i < n; ++i) {
+			double position = (strata[i] + stream.uniform()) / n;
+			points[i].push_back(factor.low + (factor.high - factor.low) * position);
+		}
+	}
+
+	return points;
+}
+
+// The design points
+std::vector<std::vector<double> > designPoints(const Experiment &experiment)
+{
+	if (experiment.design == DESIGN_LATIN_HYPERCUBE)
+		return latinHypercubePoints(experiment);
+
+	return gridPoints(experiment);
+}
+
+// The model inputs of each scenario
+bool buildScenarios(const Experiment &experiment, const ModelParameters &base, std::vector<ModelParameters> &scenarios,
+	std::string &error)
+{
+	ModelParameters fixed = base;
+	for (std::size_t i = 0; i < experiment.fixed.size(); ++i) {
+		if (!setParameter(fixed, experiment.fixed[i].first, experiment.fixed[i].second, error))
+			return false;
+	}
+
+	std::vector<std::vector<double> > points = designPoints(experiment);
+	scenarios.assign(points.size(), fixed);
+	for (std::size_t s = 0; s < points.size(); ++s) {
+		std::ostringstream scenario;
+		scenario << "scenario " << s + 1 << " (";
+		for (std::size_t f = 0; f < experiment.factors.size(); ++f)
+			scenario << (f > 0 ? ", " : "") << experiment.factors[f].name << " = " << points[s][f];
+		scenario << "): ";
+
+		for (std::size_t f = 0; f < experiment.factors.size(); ++f) {
+			if (!setParameter(scenarios[s], experiment.factors[f].name, points[s][f], error)) {
+				error = scenario.str() + error;
+				return false;
+			}
+		}
+
+		// The plant of the scenario must be one that can be simulated
+		PlantModel model = buildPlantModel(scenarios[s]);
+		if (!model.validate(error)) {
+			error = scenario.str() + error;
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,70 @@
+// Header file for the experiment designs of the Experiment tool
+#ifndef EXPERIMENT_DESIGN_H
+#define EXPERIMENT_DESIGN_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "ModelParameters.h"
+#include "RankingSelection.h"
+
+// How the design points (scenarios) are generated from the factors
+enum DesignType {
+	DESIGN_GRID,           // Full factorial: every combination of the levels of the factors
+	DESIGN_LATIN_HYPERCUBE // 'points' scenarios; the range of each factor is split in 'points' strata, each used once
+};
+
+// A model input that varies between scenarios
+struct Factor {
+	std::string name;           // Name of the input in ModelParameters (see setParameter)
+	std::vector<double> levels; // Levels of a full factorial design
+	double low;                 // Range of a Latin hypercube design
+	double high;
+};
+
+// An experiment, as read from an experiment file:
+//
+//   # Comments start with '#'
+//   design grid                            (or: design lhs)
+//   points 500                             (Latin hypercube only: number of scenarios)
+//   seed 1                                 (Latin hypercube only: seed of the sampling)
+//   set numSimulations 5                   (an input with the same value in all scenarios)
+//   levels srvcTime_Coating_Mean 4 5 6     (full factorial only: a factor and its levels)
+//   range interArr_RodEnd 4 6              (Latin hypercube only: a factor and its range)
+//
+// Inputs that are not set keep the values of ModelParameters.cpp. Instead of numSimulations replications of
+// every scenario, the experiment can select the best scenario for one statistic (see RankingSelection.h):
+//
+//   select timeInSystem min                (the statistic, min or max: created, delivered, timeInSystem,
+//                                           numInSystem, assemblyBusy or reworkBusy)
+//   procedure kn 0.95 0.5                  (KN: probability of correct selection and indifference zone)
+//   procedure ocba 1000 20                 (or OCBA: total observations and observations added per round)
+//   initial 10                             (first observations of every scenario)
+struct Experiment {
+	Experiment() : design(DESIGN_GRID), points(0), seed(1), select(false) {}
+
+	DesignType design;
+	int points;
+	unsigned long long seed;
+	std::vector<std::pair<std::string, double> > fixed;
+	std::vector<Factor> factors;
+
+	bool select; // Whether the best scenario is selected
+	SelectionSettings selection;
+};
+
+// Read an experiment file. Returns false, with a message in 'error', if the file cannot be read or is invalid,
+// including a value that its model input does not accept (see setParameter).
+bool loadExperiment(const std::string &path, Experiment &, std::string &error);
+
+// The design points: the values of the factors (in order of the factors) in each scenario
+std::vector<std::vector<double> > designPoints(const Experiment &);
+
+// The model inputs of each scenario: the base inputs, changed by the fixed inputs and the design points.
+// Returns false, with a message naming the scenario and its factors, if an input is out of range or the
+// plant of a scenario cannot be simulated (see PlantModel::validate).
+bool buildScenarios(const Experiment &, const ModelParameters &base, std::vector<ModelParameters> &scenarios,
+	std::string &error);
+
+#endif /* EXPERIMENT_DESIGN_H */
@@ -0,0 +1,88 @@
+// Definition of the recorded arrival traces.
+
+#include <cstdlib> // std::strtod
+#include <cstring> // std::memcpy, std::memchr
+
+// Include header file for the arrival traces
+#include "ArrivalTrace.h"
+#include "ResultsCache.h" // Fnv1aHash
+
+// Returns true if a name ends with a suffix
+static bool endsWith(const std::string &name, const char *suffix)
+{
+	std::size_t length = std::strlen(suffix);
+	return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+}
+
+// Map a trace file
+bool ArrivalTrace::open(const std::string &path, std::string &error)
+{
+	filePath = path;
+	format = (endsWith(path, ".csv") || endsWith(path, ".txt")) ? ARRIVALS_CSV : ARRIVALS_BINARY;
+
+	if (!file.open(path)) {
+		error = "cannot open the arrival trace " + path;
+		return false;
+	}
+	if (format == ARRIVALS_BINARY && file.size() % sizeof(double) != 0) {
+		error = "the arrival trace " + path + " is not a whole number of binary times";
+		return false;
+	}
+
+	return true;
+}
+
+// Hash of the contents of the file
+std::uint64_t ArrivalTrace::contentHash() const
+{
+	std::call_once(hashOnce, [this] {
+		Fnv1aHash contents;
+		contents.addValue(static_cast<std::int32_t>(format));
+		contents.add(file.data(), file.size());
+		hash = contents.value();
+	});
+
+	return hash;
+}
+
+// Read the next arrival time
+bool ArrivalTraceReader::next(double &time)
+{
+	const char *data = trace->data();
+	std::size_t size = trace->size();
+
+	// Binary: the time is read in place
+	if (trace->fileFormat() == ARRIVALS_BINARY) {
+		if (size - offset < sizeof(double))
+			return false;
+		std::memcpy(&time, data + offset, sizeof(double));
+		offset += sizeof(double);
+		return true;
+	}
+
+	// CSV: the first column of the next line that starts with a number. Only the number is copied, since
+	// the mapped file does not end with a null character.
+	while (offset < size) {
+		const char *line = data + offset;
+		const char *end = static_cast<const char *>(std::memchr(line, '\n', size - offset));
+		std::size_t length = end ? static_cast<std::size_t>(end - line) : size - offset;
+		offset += end ? length + 1 : length;
+
+		char number[64];
+		std::size_t digits = 0;
+		while (digits < length && digits + 1 < sizeof(number) && line[digits] != ',' && line[digits] != ';' && line[digits] != '\r') {
+			number[digits] = line[digits];
+			digits++;
+		}
+		number[digits] = 0;
+
+		char *parsed;
+		double value = std::strtod(number, &parsed);
+		if (parsed != number) {
+			time = value;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,79 @@
+// Header file for the recorded arrival traces
+#ifndef ARRIVAL_TRACE_H
+#define ARRIVAL_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "MappedFile.h"
+
+// Format of an arrival trace file
+enum ArrivalTraceFormat {
+	ARRIVALS_BINARY, // Arrival times (mins) as 8-byte doubles in the byte order of the machine, nothing else
+	ARRIVALS_CSV     // One arrival per line, its time (mins) in the first column. Lines that do not start
+	                 // with a number (e.g. a header) are skipped.
+};
+
+// The recorded arrival times of a part type, replayed instead of its interarrival distribution (see
+// PartType). Times are from the start of the simulation, in nondecreasing order; every simulation
+// replays the same arrivals from the start of the file.
+//
+// The file is memory-mapped and never copied: the operating system pages it in as the simulations
+// read it, so a history of millions of arrivals costs neither the memory to hold it nor the time to
+// load it, and only the next arrival of each part type is in the FEL. An ArrivalTrace is read-only
+// once opened, so simulations running in parallel share it, each with its own ArrivalTraceReader.
+class ArrivalTrace {
+public:
+	ArrivalTrace() : format(ARRIVALS_BINARY), hash(0) {}
+
+	// Map a file. The format is CSV if the name ends with ".csv" or ".txt", binary otherwise.
+	// Returns false with a message if the file cannot be mapped or is not a whole number of binary times.
+	bool open(const std::string &path, std::string &error);
+
+	const std::string &path() const { return filePath; }
+	ArrivalTraceFormat fileFormat() const { return format; }
+	const char *data() const { return file.data(); }
+	std::size_t size() const { return file.size(); }
+
+	// Hash of the contents of the file (64-bit FNV-1a), computed the first time it is asked for, to tell
+	// results of different traces apart (see ResultsCache)
+	std::uint64_t contentHash() const;
+
+private:
+	ArrivalTrace(const ArrivalTrace &);
+	ArrivalTrace &operator=(const ArrivalTrace &);
+
+	MappedFile file;
+	std::string filePath;
+	ArrivalTraceFormat format;
+
+	mutable std::once_flag hashOnce;
+	mutable std::uint64_t hash;
+};
+
+// The position of one simulation in an arrival trace
+class ArrivalTraceReader {
+public:
+	ArrivalTraceReader() : trace(0), offset(0) {}
+
+	// Start reading a trace from its first arrival (or from a byte offset, see position)
+	void reset(const ArrivalTrace *arrivalTrace, std::uint64_t start = 0)
+	{
+		trace = arrivalTrace;
+		offset = static_cast<std::size_t>(start);
+	}
+
+	// Read the next arrival time. Returns false at the end of the trace.
+	bool next(double &time);
+
+	// Byte offset of the next arrival in the file, kept in snapshots
+	std::uint64_t position() const { return offset; }
+
+private:
+	const ArrivalTrace *trace;
+	std::size_t offset;
+};
+
+#endif /* ARRIVAL_TRACE_H */
@@ -0,0 +1,196 @@
+// Definition of the binary event trace.
+
+#include <cstring> // std::memcpy, std::memset
+
+// Include header file for the binary event trace
+#include "BinaryTrace.h"
+
+// Convert a row of the event trace to a binary record
+TraceRecord toTraceRecord(const TraceRow &row)
+{
+	TraceRecord record;
+	std::memset(&record, 0, sizeof(record));
+
+	record.simulationTime = row.simulationTime;
+	record.totalTimeAssembliesInSystem = row.totalTimeAssembliesInSystem;
+	record.cumAssemblies_Time_InSystem = row.cumAssemblies_Time_InSystem;
+	record.partID = row.event.getPartID();
+	record.nextID = static_cast<std::uint32_t>(row.nextID);
+	for (int s = 0; s < row.numStations; ++s)
+		record.numAtStation[s] = row.numAtStation[s];
+	record.totalAssembliesCreated = static_cast<std::uint32_t>(row.totalAssembliesCreated);
+	record.totalAssembliesDelivered = static_cast<std::uint32_t>(row.totalAssembliesDelivered);
+	record.eventType = static_cast<std::uint8_t>(eventTypeToCode(row.event.getEventType()));
+	record.numStations = static_cast<std::uint8_t>(row.numStations);
+	record.location = static_cast<std::uint16_t>(row.location);
+
+	return record;
+}
+
+// Convert a binary record back to a row of the event trace
+TraceRow fromTraceRecord(const TraceRecord &record)
+{
+	TraceRow row;
+	row.simulationTime = record.simulationTime;
+	row.event = Event(eventTypeFromCode(static_cast<char>(record.eventType)), record.simulationTime, record.partID);
+	row.location = record.location;
+	row.numStations = (record.numStations < maxTraceStations) ? record.numStations : maxTraceStations;
+	for (int s = 0; s < row.numStations; ++s)
+		row.numAtStation[s] = record.numAtStation[s];
+	row.totalAssembliesCreated = record.totalAssembliesCreated;
+	row.totalAssembliesDelivered = record.totalAssembliesDelivered;
+	row.totalTimeAssembliesInSystem = record.totalTimeAssembliesInSystem;
+	row.cumAssemblies_Time_InSystem = record.cumAssemblies_Time_InSystem;
+	row.nextID = record.nextID;
+
+	return row;
+}
+
+//////////////////////////////////////////////////
+//               BinaryTraceFile                //
+//////////////////////////////////////////////////
+
+// Constructor
+BinaryTraceFile::BinaryTraceFile() : file(0), closing(false), recordCount(0) {}
+
+// Destructor
+BinaryTraceFile::~BinaryTraceFile()
+{
+	close();
+}
+
+// Write a file header
+static void writeFileHeader(std::FILE *file, std::uint64_t recordCount)
+{
+	TraceFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DESTRACE", 8);
+	header.version = traceFileVersion;
+	header.byteOrderMark = traceByteOrderMark;
+	header.recordSize = sizeof(TraceRecord);
+	header.recordCount = recordCount;
+
+	std::fwrite(&header, sizeof(header), 1, file);
+}
+
+// Create the file and start the background writer
+bool BinaryTraceFile::open(const std::string &path)
+{
+	close();
+
+	file = std::fopen(path.c_str(), "wb");
+	if (file == 0)
+		return false;
+
+	// The record count is filled in when the file is closed
+	writeFileHeader(file, 0);
+
+	closing = false;
+	recordCount = 0;
+	writer = std::thread(&BinaryTraceFile::writerLoop, this);
+	return true;
+}
+
+// Write all queued blocks, complete the file header and stop the background writer
+void BinaryTraceFile::close()
+{
+	if (file == 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+	queued.notify_one();
+	writer.join();
+
+	std::fseek(file, 0, SEEK_SET);
+	writeFileHeader(file, recordCount);
+	std::fclose(file);
+	file = 0;
+}
+
+// Queue a block to be written
+void BinaryTraceFile::submit(TraceBlock *block)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		block->writing = true;
+		queue.push_back(block);
+	}
+	queued.notify_one();
+}
+
+// Block until a submitted block has been written
+void BinaryTraceFile::waitWritten(TraceBlock *block)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	written.wait(lock, [block] { return !block->writing; });
+}
+
+// Main loop of the background writer thread
+void BinaryTraceFile::writerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (1) {
+		queued.wait(lock, [this] { return closing || !queue.empty(); });
+		if (queue.empty())
+			return; // Closing, and everything has been written
+
+		TraceBlock *block = queue.front();
+		queue.pop_front();
+
+		// Write the block without holding the lock
+		lock.unlock();
+		block->header.recordCount = static_cast<std::uint32_t>(block->records.size());
+		std::fwrite(&block->header, sizeof(block->header), 1, file);
+		if (!block->records.empty())
+			std::fwrite(&block->records[0], sizeof(TraceRecord), block->records.size(), file);
+		lock.lock();
+
+		recordCount += block->records.size();
+		block->writing = false;
+		written.notify_all();
+	}
+}
+
+//////////////////////////////////////////////////
+//              BinaryTraceChannel              //
+//////////////////////////////////////////////////
+
+// Constructor
+BinaryTraceChannel::BinaryTraceChannel(BinaryTraceFile *traceFile, int replication) : file(traceFile)
+{
+	for (int b = 0; b < 2; ++b) {
+		blocks[b].header.replication = static_cast<std::uint32_t>(replication);
+		blocks[b].header.recordCount = 0;
+		blocks[b].records.reserve(BinaryTraceFile::blockCapacity);
+		blocks[b].writing = false;
+	}
+	active = &blocks[0];
+}
+
+// Destructor
+BinaryTraceChannel::~BinaryTraceChannel()
+{
+	flush();
+}
+
+// Hand over the active block and continue with the other one, once it has been written
+void BinaryTraceChannel::swapBlocks()
+{
+	file->submit(active);
+	active = (active == &blocks[0]) ? &blocks[1] : &blocks[0];
+	file->waitWritten(active);
+	active->records.clear();
+}
+
+// Hand over the records appended so far and wait until all of them have been written
+void BinaryTraceChannel::flush()
+{
+	if (!active->records.empty())
+		swapBlocks();
+
+	file->waitWritten(&blocks[0]);
+	file->waitWritten(&blocks[1]);
+}
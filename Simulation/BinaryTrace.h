@@ -0,0 +1,165 @@
+// Header file for the binary event trace
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "TracePolicies.h"
+
+// One row of the event trace as a fixed-width binary record (64 bytes). Unlike the CSV trace,
+// times and statistics keep their full precision.
+struct TraceRecord {
+	double simulationTime;
+	double totalTimeAssembliesInSystem;
+	double cumAssemblies_Time_InSystem;
+	std::uint32_t partID;
+	std::uint32_t nextID;
+	std::uint32_t totalAssembliesCreated;
+	std::uint32_t totalAssembliesDelivered;
+	std::uint8_t eventType;      // Letter code of the event type (see eventTypeToCode)
+	std::uint8_t numStations;    // Number of entries of numAtStation in use
+	std::uint16_t location;      // Part type of an arrival, or station of a departure or downtime event
+	std::int32_t numAtStation[maxTraceStations];
+};
+
+// Convert between a row of the event trace and a binary record
+TraceRecord toTraceRecord(const TraceRow &);
+TraceRow fromTraceRecord(const TraceRecord &);
+
+// Layout of a binary trace file. The file starts with a TraceFileHeader, followed by blocks. Each block
+// is a TraceBlockHeader followed by 'recordCount' TraceRecords of a single simulation. Blocks of the
+// same simulation appear in order, but blocks of simulations run in parallel may be interleaved.
+// All records are 8-byte aligned, so the file can be memory-mapped and read in place.
+struct TraceFileHeader {
+	char magic[8];               // "DESTRACE"
+	std::uint32_t version;
+	std::uint32_t byteOrderMark; // 0x01020304 in the byte order of the machine that wrote the file
+	std::uint32_t recordSize;    // sizeof(TraceRecord)
+	std::uint32_t reserved;
+	std::uint64_t recordCount;   // Total number of records (written when the file is closed)
+};
+
+struct TraceBlockHeader {
+	std::uint32_t replication;   // Simulation number, starting at 0
+	std::uint32_t recordCount;
+};
+
+static const std::uint32_t traceFileVersion = 2;
+static const std::uint32_t traceByteOrderMark = 0x01020304;
+
+// A block of records being filled by one simulation or written by the background thread
+struct TraceBlock {
+	TraceBlockHeader header;
+	std::vector<TraceRecord> records;
+	bool writing; // True while the block is queued or being written
+};
+
+// A binary trace file. Simulations hand over full blocks of records, which a background thread
+// writes to disk, so the simulations never wait for the disk unless it falls behind.
+class BinaryTraceFile {
+public:
+	BinaryTraceFile();
+	~BinaryTraceFile();
+
+	// Create the file and start the background writer. Returns false if the file cannot be created.
+	bool open(const std::string &path);
+
+	// Write all queued blocks, complete the file header and stop the background writer
+	void close();
+
+	// Queue a block to be written. The block must not be touched until waitWritten() returns.
+	void submit(TraceBlock *);
+
+	// Block until a submitted block has been written
+	void waitWritten(TraceBlock *);
+
+	// Number of records per block
+	static const std::size_t blockCapacity = 4096;
+
+private:
+	void writerLoop();
+
+	std::FILE *file;
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable queued;  // Signalled when a block is submitted or the file closes
+	std::condition_variable written; // Signalled when a block has been written
+	std::deque<TraceBlock *> queue;
+	bool closing;
+	std::uint64_t recordCount;
+};
+
+// The records of one simulation, double buffered: one block is filled while the other is written.
+class BinaryTraceChannel {
+public:
+	BinaryTraceChannel(BinaryTraceFile *, int replication);
+	~BinaryTraceChannel();
+
+	// Append a record
+	void append(const TraceRecord &record)
+	{
+		if (active->records.size() == BinaryTraceFile::blockCapacity)
+			swapBlocks();
+		active->records.push_back(record);
+	}
+
+	// Hand over the records appended so far and wait until all of them have been written
+	void flush();
+
+private:
+	// Hand over the active block and continue with the other one
+	void swapBlocks();
+
+	BinaryTraceFile *file;
+	TraceBlock blocks[2];
+	TraceBlock *active;
+};
+
+// Trace policy that appends a binary record per event to a BinaryTraceFile (see TracePolicies.h).
+// Convert the file to today's CSV layout with the TraceToCsv tool. The records hold the indices of
+// part types and stations, not their names, so a trace of a model read from a file is converted with
+// the same model file.
+class BinaryTrace {
+public:
+	static const bool recordsEvents = true;
+	static const bool recordsSummary = false;
+	static const bool printsEventList = false;
+
+	explicit BinaryTrace(BinaryTraceFile *traceFile = 0) : file(traceFile) {}
+
+	void beginReplication(int replication, const PlantModel &)
+	{
+		if (file != 0)
+			channel = std::make_shared<BinaryTraceChannel>(file, replication);
+	}
+
+	void recordEvent(const TraceRow &row)
+	{
+		if (channel)
+			channel->append(toTraceRecord(row));
+	}
+
+	void endReplication(const TraceRow &)
+	{
+		if (channel)
+			channel->flush();
+		channel.reset();
+	}
+
+	std::ostream &console() { return std::cerr; }
+	void moveOutput(ReplicationOutput &) {}
+
+private:
+	BinaryTraceFile *file;
+	std::shared_ptr<BinaryTraceChannel> channel;
+};
+
+#endif /* BINARY_TRACE_H */
@@ -0,0 +1,198 @@
+// Header file for the entity store and entity queues
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Handle of an entity in an EntityStore. A handle of 0 is a tag for an invalid handle (no entity),
+// like the part ID of 0 of an Event.
+typedef std::uint32_t EntityHandle;
+
+// Number of station visits kept in the route history of an entity
+static const int maxRouteHistory = 8;
+
+// Everything the model keeps about one Assembly entity
+struct EntityRecord {
+	double creationTime;         // Simulation time when the entity was created
+	double arrivalTime;          // Simulation time when the entity arrived at its station
+	std::uint32_t serialNumber;  // Order of creation, starting at 1 (the part ID shown in the event trace)
+	std::uint16_t reworkCount;   // Number of times the entity has been through rework
+	std::uint16_t station;       // Station the entity is at (in service or in its queue)
+	std::uint16_t server;        // Server of the station serving the entity (if in service)
+	std::uint8_t routeLength;    // Number of station visits recorded in 'route'
+	std::uint8_t routeOverflow;  // 1 if the entity visited more stations than 'route' can hold
+	std::uint8_t route[maxRouteHistory]; // Stations visited, in order (the first maxRouteHistory visits, low 8 bits of the station index)
+	EntityHandle nextFree;       // Link in the free list while the record is not in use
+};
+
+// A pool of entity records stored contiguously. Records of entities that leave the system are
+// recycled through a free list, so creating, finding and releasing an entity are O(1), and there is
+// no allocation once the pool has grown to the largest number of entities in the system at once.
+class EntityStore {
+public:
+	EntityStore() : freeList(0), live(0), nextSerial(1) {}
+
+	// Create an entity and return its handle
+	EntityHandle create(double creationTime)
+	{
+		EntityHandle handle;
+		if (freeList != 0) {
+			handle = freeList;
+			freeList = records[handle - 1].nextFree;
+		}
+		else {
+			records.push_back(EntityRecord());
+			handle = static_cast<EntityHandle>(records.size());
+		}
+
+		EntityRecord &record = records[handle - 1];
+		record.creationTime = creationTime;
+		record.arrivalTime = creationTime;
+		record.serialNumber = nextSerial++;
+		record.reworkCount = 0;
+		record.station = 0;
+		record.server = 0;
+		record.routeLength = 0;
+		record.routeOverflow = 0;
+		record.nextFree = 0;
+		live++;
+
+		return handle;
+	}
+
+	// Add an entity that comes from another store (e.g. of another logical process, see ParallelEngine.h),
+	// with its record, serial number included, and return its handle here
+	EntityHandle adopt(const EntityRecord &from)
+	{
+		EntityHandle handle;
+		if (freeList != 0) {
+			handle = freeList;
+			freeList = records[handle - 1].nextFree;
+		}
+		else {
+			records.push_back(EntityRecord());
+			handle = static_cast<EntityHandle>(records.size());
+		}
+
+		records[handle - 1] = from;
+		records[handle - 1].nextFree = 0;
+		live++;
+
+		return handle;
+	}
+
+	// Release an entity that left the system. Its handle may be given to a new entity.
+	void release(EntityHandle handle)
+	{
+		records[handle - 1].nextFree = freeList;
+		freeList = handle;
+		live--;
+	}
+
+	// Access the record of an entity
+	EntityRecord &operator[](EntityHandle handle) { return records[handle - 1]; }
+	const EntityRecord &operator[](EntityHandle handle) const { return records[handle - 1]; }
+
+	// Record a visit of an entity to a station, where it arrives at 'time'
+	void visit(EntityHandle handle, std::uint16_t station, double time)
+	{
+		EntityRecord &record = records[handle - 1];
+		record.station = station;
+		record.arrivalTime = time;
+		if (record.routeLength < maxRouteHistory)
+			record.route[record.routeLength++] = static_cast<std::uint8_t>(station);
+		else
+			record.routeOverflow = 1;
+	}
+
+	// Remove all entities
+	void clear()
+	{
+		records.clear();
+		freeList = 0;
+		live = 0;
+		nextSerial = 1;
+	}
+
+	// Number of entities in the system
+	std::size_t size() const { return live; }
+
+	// Serial number that will be given to the next entity
+	std::uint32_t nextSerialNumber() const { return nextSerial; }
+
+	// The whole store (used and free records), for snapshots of the simulation (see Snapshot.h)
+	const std::vector<EntityRecord> &allRecords() const { return records; }
+	EntityHandle firstFree() const { return freeList; }
+
+	// Restore the whole store from a snapshot
+	void restore(const std::vector<EntityRecord> &allRecords, EntityHandle firstFree, std::uint32_t numLive, std::uint32_t nextSerialNumber)
+	{
+		records = allRecords;
+		freeList = firstFree;
+		live = numLive;
+		nextSerial = nextSerialNumber;
+	}
+
+private:
+	std::vector<EntityRecord> records;
+	EntityHandle freeList;
+	std::uint32_t live;
+	std::uint32_t nextSerial;
+};
+
+// First In First Out queue of entity handles, stored in a ring buffer that doubles when it is full.
+// Unlike std::queue (a std::deque), it does not allocate once it has grown to its largest size.
+class EntityQueue {
+public:
+	EntityQueue() : head(0), count(0), buffer(16) {}
+
+	bool empty() const { return count == 0; }
+	std::size_t size() const { return count; }
+
+	// Access the next element
+	EntityHandle front() const { return buffer[head]; }
+
+	// Access the i-th element from the front
+	EntityHandle operator[](std::size_t i) const { return buffer[(head + i) & (buffer.size() - 1)]; }
+
+	// Add an element at the back
+	void push(EntityHandle handle)
+	{
+		if (count == buffer.size())
+			grow();
+		buffer[(head + count) & (buffer.size() - 1)] = handle;
+		count++;
+	}
+
+	// Remove the next element
+	void pop()
+	{
+		head = (head + 1) & (buffer.size() - 1);
+		count--;
+	}
+
+	void clear()
+	{
+		head = 0;
+		count = 0;
+	}
+
+private:
+	// Double the size of the ring buffer (its size is always a power of 2)
+	void grow()
+	{
+		std::vector<EntityHandle> larger(buffer.size() * 2);
+		for (std::size_t i = 0; i < count; ++i)
+			larger[i] = buffer[(head + i) & (buffer.size() - 1)];
+		buffer.swap(larger);
+		head = 0;
+	}
+
+	std::size_t head;
+	std::size_t count;
+	std::vector<EntityHandle> buffer;
+};
+
+#endif /* ENTITY_STORE_H */
@@ -2,46 +2,45 @@
 
 #include <iostream>
 #include <string>
+#include <type_traits> // std::is_trivially_copyable
 
 // Include header file for class Event
 #include "Event.h"
 
-// Default contructor
-Event::Event()
-{
-	eventType = 'w'; // This is not a real event.
-	timeOfEvent = std::numeric_limits<double>::infinity();
-	partID = 0; // This is an indicator that the partID number is not 'real'
-}
+static_assert(sizeof(Event) == 16, "An Event must fit in 16 bytes");
+static_assert(std::is_trivially_copyable<Event>::value, "An Event must be trivially copyable");
 
-// Constructor without a part ID associated with an assembly part
-Event::Event(char type, double time)
+// Letter codes of the event types, indexed by EventType
+static const char eventTypeCodes[NUM_EVENT_TYPES] = { 'w', 'a', 'x', 'e', 'f', 'r', 'b', 's' };
+
+// Convert an event type to its letter code
+char eventTypeToCode(EventType type)
 {
-	eventType = type;
-	timeOfEvent = time;
-	partID = 0; // This is an indicator that the partID number is not 'real'.
+	if (type < 0 || type >= NUM_EVENT_TYPES)
+		return 'w';
 
-};
+	return eventTypeCodes[type];
+}
 
-// Constructor without a part ID associated with an assembly part
-Event::Event(char type, double time, double ID)
+// Convert a letter code to an event type. Returns EVENT_NONE if the code is unknown.
+EventType eventTypeFromCode(char code)
 {
-	eventType = type;
-	timeOfEvent = time;
-	partID = ID;
-};
+	for (int type = 0; type < NUM_EVENT_TYPES; ++type) {
+		if (eventTypeCodes[type] == code)
+			return static_cast<EventType>(type);
+	}
 
-// Destructor
-Event::~Event(void) {};
+	return EVENT_NONE;
+}
 
 // Overloaded operator ==
 bool Event::operator==(const Event &other) const
 {
-	return (eventType == other.eventType) && (timeOfEvent == other.timeOfEvent);
+	return (getEventType() == other.getEventType()) && (timeOfEvent == other.timeOfEvent);
 }
 
 // Returns true if the event has a valid partID, false otherwise
-bool  Event::hasValidPartID()
+bool  Event::hasValidPartID() const
 {
 	if (partID == 0) {
 		return false;
@@ -50,74 +49,29 @@ bool  Event::hasValidPartID()
 	return true;
 }
 
-// Convert eventType to String
-std::string Event::eventTypeToString()
+// Convert eventType to String. The trace names the part type or station as well (see TraceNames).
+std::string Event::eventTypeToString() const
 {
+	switch (getEventType()) {
+	case EVENT_ARRIVAL:
+		return "Arrival";
+	case EVENT_DEPARTURE:
+		return "Departure";
 
-	// 'a' for Rod End arrival
-	// 'b' for Piston arrival
-	// 'c' for Cylinder Cap arrival
-	// 'd' for Cylinder arrival
-	// 'f' for Cyinder Rod End arrival
-
-	// 'e' for End of Simulation
-
-	// 'x' for departure from Assembly station
-	// 'y' for departure from Coating station
-	// 'z' for departure from ReWork station
-
-	if (eventType == 'a')
-		return "Arrival: Rod End";
-	if (eventType == 'b')
-		return "Arrival: Piston";
-	if (eventType == 'c')
-		return "Arrival: Cylinder Cap";
-	if (eventType == 'd')
-		return "Arrival: Cylinder";
-	if (eventType == 'f')
-		return "Arrival: Cylinder Rod End";
-
-	if (eventType == 'x')
-		return "Departure: Assembly Station";
-	if (eventType == 'y')
-		return "Departure: Coating Station";
-	if (eventType == 'z')
-		return "Departure: ReWork Station";
-
-	if (eventType == 'e')
+	case EVENT_END:
 		return "End of simulation";
+	case EVENT_FAILURE:
+		return "Failure";
+	case EVENT_REPAIR:
+		return "Repair";
+	case EVENT_SHIFT_END:
+		return "Shift end";
+	case EVENT_SHIFT_START:
+		return "Shift start";
+
+	default:
+		break;
+	}
 
 	return "Error";
 }
-
-// Getter functions
-char Event::getEventType()
-{
-	return eventType;
-};
-
-double Event::getTimeOfEvent()
-{
-	return timeOfEvent;
-};
-
-double Event::getPartID()
-{
-	return partID;
-}
-
-// Setter functions
-void Event::setTimeOfEvent(double time)
-{
-	timeOfEvent = time;
-}
-
-void Event::setEventType(char type)
-{
-	eventType = type;
-}
-
-void Event::setPartID(double ID)
-{
-	partID = ID;
-}
\ No newline at end of file
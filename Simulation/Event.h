@@ -4,66 +4,93 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
 #include <math.h>       /* isfinite, sqrt */
 
+/////////////
+// EventType describes the type of event. The letter in brackets is the code of the event type
+// used in the FEL dump and in binary trace files (see eventTypeToCode).
+////////////
+enum EventType {
+	EVENT_NONE,                 // ('w') This is not a real event.
+
+	EVENT_ARRIVAL,              // ('a') Arrival of a part. The part ID is the index of its part type in the PlantModel.
+	EVENT_DEPARTURE,            // ('x') Departure of an Assembly entity from the station it is at
+
+	EVENT_END,                  // ('e') End of Simulation
+
+	// Station downtime. The part ID is the index of the station in the PlantModel.
+	EVENT_FAILURE,              // ('f') Breakdown of a station
+	EVENT_REPAIR,               // ('r') End of the repair of a station
+	EVENT_SHIFT_END,            // ('b') A station closes at the end of its shift
+	EVENT_SHIFT_START,          // ('s') A station opens at the start of its shift
+
+	NUM_EVENT_TYPES
+};
+
+// Convert an event type to its letter code and back. eventTypeFromCode returns EVENT_NONE if the code is unknown.
+char eventTypeToCode(EventType);
+EventType eventTypeFromCode(char);
+
+// An event: 16 bytes with no destructor, so events can be copied with memcpy and stored contiguously
+// in the arrays of the Future Event List.
 class Event {
 public:
 
 	// Default constructor
-	Event();
+	Event() : timeOfEvent(HUGE_VAL), partID(0), typeAndSequence(EVENT_NONE) {}
 
 	// Constructor declaration without a ID number associated with an Assembly part
-	Event(char, double);
+	Event(EventType type, double time) : timeOfEvent(time), partID(0), typeAndSequence(type) {}
 
 	// Constructor declaration including an ID number associated with an Assembly part
-	Event(char, double, double);
-
-	// Destructor declaration
-	~Event();
+	Event(EventType type, double time, std::uint32_t ID) : timeOfEvent(time), partID(ID), typeAndSequence(type) {}
 
 	// Overloaded operator ==
 	bool operator==(const Event &other) const;
 
 	// Convert eventType to String
-	std::string eventTypeToString();
+	std::string eventTypeToString() const;
 
 	// Returns true if the event has a valid partID, false otherwise
-	bool hasValidPartID();
+	bool hasValidPartID() const;
 
 	// Member function declarations (getters and setters)
-	double getTimeOfEvent();
-	char getEventType();
-	double getPartID();
-
-	void setTimeOfEvent(double);
-	void setEventType(char);
-	void setPartID(double);
+	double getTimeOfEvent() const { return timeOfEvent; }
+	EventType getEventType() const { return static_cast<EventType>(typeAndSequence & 0xFF); }
+	std::uint32_t getPartID() const { return partID; }
+	std::uint32_t getSequence() const { return typeAndSequence >> 8; }
+
+	void setTimeOfEvent(double time) { timeOfEvent = time; }
+	void setEventType(EventType type) { typeAndSequence = (typeAndSequence & ~0xFFu) | type; }
+	void setPartID(std::uint32_t ID) { partID = ID; }
+	void setSequence(std::uint32_t sequence) { typeAndSequence = (sequence << 8) | (typeAndSequence & 0xFF); }
+
+	// Returns true if this event must be executed before the other one: lowest time first, and equal
+	// times in order of their sequence numbers. Sequence numbers are 24 bits and wrap around, so they
+	// are compared as a signed difference. This is correct as long as the sequence numbers of the
+	// pending events span less than 2^23, which the FEL keeps by renumbering the events it holds for long
+	// (see FutureEventList).
+	bool precedes(const Event &other) const
+	{
+		if (timeOfEvent != other.timeOfEvent)
+			return timeOfEvent < other.timeOfEvent;
+
+		return static_cast<std::int32_t>((typeAndSequence & ~0xFFu) - (other.typeAndSequence & ~0xFFu)) < 0;
+	}
 
 private:
 	// Variable declarations.
 
 	// in minutes
 	double timeOfEvent;
-	
-	/////////////
-	// eventType is a char that describes the type of event
-	////////////
-
-	// 'a' for Rod End arrival
-	// 'b' for Piston arrival
-	// 'c' for Cylinder Cap arrival
-	// 'd' for Cylinder arrival
-	// 'f' for Cyinder Rod End arrival
-
-	// 'e' for End of Simulation
-
-	// 'x' for departure from Assembly station
-	// 'y' for departure from Coating station
-	// 'z' for departure from ReWork station
-	char eventType;
-
-	// Part ID number associated with an Assembly
-	double partID;
+
+	// Part ID number (entity handle) associated with an Assembly, the part type of an arrival, or the station of
+	// a downtime event. 0 if there is none.
+	std::uint32_t partID;
+
+	// The EventType in the low 8 bits, and the sequence number given by the Future Event List in the high 24 bits
+	std::uint32_t typeAndSequence;
 };
 
-#endif /* EVENT_H */
\ No newline at end of file
+#endif /* EVENT_H */
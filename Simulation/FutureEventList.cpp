@@ -0,0 +1,435 @@
+// Definition of the Future Event List (FEL) classes.
+
+#include <algorithm> // std::sort, std::partial_sort, std::upper_bound, std::fill
+#include <cmath>     // std::floor
+
+// Include header file for the FEL classes
+#include "FutureEventList.h"
+
+// Convert a FEL type to a string
+std::string felTypeToString(FELType type)
+{
+	switch (type) {
+	case FEL_BINARY_HEAP:
+		return "binary-heap";
+	case FEL_QUATERNARY_HEAP:
+		return "4-ary-heap";
+	case FEL_PAIRING_HEAP:
+		return "pairing-heap";
+	case FEL_CALENDAR_QUEUE:
+		return "calendar-queue";
+	}
+
+	return "Error";
+}
+
+// Convert a string to a FEL type. Returns false if the name is unknown.
+bool parseFELType(const std::string &name, FELType &type)
+{
+	if (name == "binary-heap")
+		type = FEL_BINARY_HEAP;
+	else if (name == "4-ary-heap")
+		type = FEL_QUATERNARY_HEAP;
+	else if (name == "pairing-heap")
+		type = FEL_PAIRING_HEAP;
+	else if (name == "calendar-queue")
+		type = FEL_CALENDAR_QUEUE;
+	else
+		return false;
+
+	return true;
+}
+
+// Create a Future Event List with the specified backend
+std::unique_ptr<FutureEventList> createFutureEventList(FELType type)
+{
+	switch (type) {
+	case FEL_BINARY_HEAP:
+		return std::unique_ptr<FutureEventList>(new BinaryHeapFEL());
+	case FEL_QUATERNARY_HEAP:
+		return std::unique_ptr<FutureEventList>(new QuaternaryHeapFEL());
+	case FEL_PAIRING_HEAP:
+		return std::unique_ptr<FutureEventList>(new PairingHeapFEL());
+	case FEL_CALENDAR_QUEUE:
+		return std::unique_ptr<FutureEventList>(new CalendarQueueFEL());
+	}
+
+	return std::unique_ptr<FutureEventList>();
+}
+
+// Cancel a pending event. A handle is pending if the bit of its sequence number is set: the sequence number
+// it was given, or the one it was renumbered to. The bits are set from the events held at the first cancel.
+bool FutureEventList::cancel(EventHandle handle)
+{
+	if (handle >= nextHandle)
+		return false;
+
+	// Events held at the last renumbering that were scheduled before the period that ended there were given
+	// new sequence numbers. Older handles not among them are no longer held.
+	std::uint32_t sequence;
+	std::unordered_map<EventHandle, std::uint32_t>::const_iterator moved = renumbered.find(handle);
+	if (moved != renumbered.end())
+		sequence = moved->second;
+	else if (handle + renumberingPeriod < lastRenumbering)
+		return false;
+	else
+		sequence = static_cast<std::uint32_t>(handle & (numSequences - 1));
+
+	if (pending.empty()) {
+		pending.assign(numSequences / 64, 0);
+		std::vector<Event> held;
+		collect(held);
+		for (std::size_t i = 0; i < held.size(); ++i)
+			setPending(held[i].getSequence(), true);
+	}
+
+	if (!isPending(sequence))
+		return false;
+
+	setPending(sequence, false);
+	cancelled.insert(sequence);
+	return true;
+}
+
+// Drop the cancelled events and give new sequence numbers to the events scheduled more than one period
+// before now. They keep their order and come just before the events of the last period, so the sequence
+// numbers of the events held span at most two periods plus the number of events renumbered.
+void FutureEventList::renumber()
+{
+	std::uint32_t nextSequence = static_cast<std::uint32_t>(nextHandle & (numSequences - 1));
+	auto age = [&](std::uint32_t sequence) { return (nextSequence - sequence) & (numSequences - 1); };
+
+	// Handles of the events renumbered last time, by their sequence number
+	std::unordered_map<std::uint32_t, EventHandle> handleOf;
+	for (std::unordered_map<EventHandle, std::uint32_t>::const_iterator i = renumbered.begin(); i != renumbered.end(); ++i)
+		handleOf[i->second] = i->first;
+	renumbered.clear();
+
+	std::vector<Event> held;
+	collect(held);
+	removeAll();
+
+	// Keep the events that were not cancelled. The old ones are put in order, oldest first.
+	std::vector<Event> old;
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < held.size(); ++i) {
+		if (cancelled.count(held[i].getSequence()))
+			continue;
+		if (age(held[i].getSequence()) > renumberingPeriod)
+			old.push_back(held[i]);
+		else
+			held[kept++] = held[i];
+	}
+	held.resize(kept);
+	std::sort(old.begin(), old.end(), [&](const Event &a, const Event &b) { return age(a.getSequence()) > age(b.getSequence()); });
+
+	// Renumber the old events, and remember the new sequence numbers of their handles
+	for (std::size_t i = 0; i < old.size(); ++i) {
+		std::uint32_t sequence = old[i].getSequence();
+		std::unordered_map<std::uint32_t, EventHandle>::const_iterator known = handleOf.find(sequence);
+		EventHandle handle = (known != handleOf.end()) ? known->second : nextHandle - age(sequence);
+
+		std::uint32_t newSequence = static_cast<std::uint32_t>((nextHandle - renumberingPeriod - old.size() + i) & (numSequences - 1));
+		old[i].setSequence(newSequence);
+		renumbered[handle] = newSequence;
+		held.push_back(old[i]);
+	}
+
+	cancelled.clear();
+	if (!pending.empty())
+		std::fill(pending.begin(), pending.end(), 0);
+	for (std::size_t i = 0; i < held.size(); ++i) {
+		push(held[i]);
+		if (!pending.empty())
+			setPending(held[i].getSequence(), true);
+	}
+
+	lastRenumbering = nextHandle;
+}
+
+// Returns a copy of all pending events in the order in which they will occur
+std::vector<Event> FutureEventList::pendingEvents() const
+{
+	std::vector<Event> events;
+	collect(events);
+	if (!cancelled.empty()) {
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < events.size(); ++i) {
+			if (cancelled.count(events[i].getSequence()) == 0)
+				events[kept++] = events[i];
+		}
+		events.resize(kept);
+	}
+	std::sort(events.begin(), events.end(), precedes);
+
+	return events;
+}
+
+//////////////////////////////////////////////////
+//                 Pairing heap                 //
+//////////////////////////////////////////////////
+
+PairingHeapFEL::PairingHeapFEL() : root(NIL), freeList(NIL), count(0) {}
+
+// Link two heaps: the root that occurs later becomes the first child of the other root
+int PairingHeapFEL::meld(int a, int b)
+{
+	if (a == NIL)
+		return b;
+	if (b == NIL)
+		return a;
+
+	if (precedes(nodes[b].item, nodes[a].item))
+		std::swap(a, b);
+
+	nodes[b].sibling = nodes[a].child;
+	nodes[a].child = b;
+	return a;
+}
+
+void PairingHeapFEL::push(const Event &scheduled)
+{
+	// Take a node from the free list, or grow the pool
+	int n;
+	if (freeList != NIL) {
+		n = freeList;
+		freeList = nodes[n].sibling;
+	}
+	else {
+		n = static_cast<int>(nodes.size());
+		nodes.push_back(Node());
+	}
+
+	nodes[n].item = scheduled;
+	nodes[n].child = NIL;
+	nodes[n].sibling = NIL;
+
+	root = meld(root, n);
+	count++;
+}
+
+Event PairingHeapFEL::pop()
+{
+	int oldRoot = root;
+	Event top = nodes[oldRoot].item;
+
+	// First pass: meld the children of the root in pairs, from left to right
+	pairs.clear();
+	int child = nodes[oldRoot].child;
+	while (child != NIL) {
+		int first = child;
+		int second = nodes[first].sibling;
+		child = (second != NIL) ? nodes[second].sibling : NIL;
+
+		nodes[first].sibling = NIL;
+		if (second != NIL)
+			nodes[second].sibling = NIL;
+
+		pairs.push_back(meld(first, second));
+	}
+
+	// Second pass: meld the pairs from right to left
+	root = NIL;
+	for (std::size_t i = pairs.size(); i > 0; --i)
+		root = meld(pairs[i - 1], root);
+
+	// Return the old root to the free list
+	nodes[oldRoot].sibling = freeList;
+	freeList = oldRoot;
+	count--;
+
+	return top;
+}
+
+void PairingHeapFEL::removeAll()
+{
+	nodes.clear();
+	root = NIL;
+	freeList = NIL;
+	count = 0;
+}
+
+void PairingHeapFEL::collect(std::vector<Event> &out) const
+{
+	// Walk the tree (children and siblings) starting at the root
+	std::vector<int> stack;
+	if (root != NIL)
+		stack.push_back(root);
+
+	while (!stack.empty()) {
+		int n = stack.back();
+		stack.pop_back();
+		out.push_back(nodes[n].item);
+
+		if (nodes[n].child != NIL)
+			stack.push_back(nodes[n].child);
+		if (n != root && nodes[n].sibling != NIL)
+			stack.push_back(nodes[n].sibling);
+	}
+}
+
+//////////////////////////////////////////////////
+//                Calendar queue                //
+//////////////////////////////////////////////////
+
+// Minimum number of buckets in the calendar
+static const std::size_t minBuckets = 2;
+
+// Number of events used to estimate the width of a day
+static const std::size_t widthSampleSize = 25;
+
+// Returns true if event a must be executed AFTER event b. Buckets are sorted with this
+// predicate so that the event that is next to occur is at the back of the bucket.
+static bool follows(const Event &a, const Event &b)
+{
+	return precedes(b, a);
+}
+
+CalendarQueueFEL::CalendarQueueFEL() : buckets(minBuckets), width(1.0), current(0), currentDay(0), count(0) {}
+
+// Index of the day holding a given time
+long long CalendarQueueFEL::dayOf(double time) const
+{
+	return static_cast<long long>(std::floor(time / width));
+}
+
+// Index of the bucket holding a given time
+std::size_t CalendarQueueFEL::bucketOf(double time) const
+{
+	long long n = static_cast<long long>(buckets.size());
+	long long b = dayOf(time) % n;
+	if (b < 0)
+		b += n;
+
+	return static_cast<std::size_t>(b);
+}
+
+// Move the current day to the one holding a given time
+void CalendarQueueFEL::moveTo(double time)
+{
+	currentDay = dayOf(time);
+	current = bucketOf(time);
+}
+
+void CalendarQueueFEL::push(const Event &scheduled)
+{
+	std::vector<Event> &bucket = buckets[bucketOf(scheduled.getTimeOfEvent())];
+	bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), scheduled, follows), scheduled);
+
+	// If the event occurs before the current day (or the calendar was empty), move back to it
+	if (count == 0 || dayOf(scheduled.getTimeOfEvent()) < currentDay)
+		moveTo(scheduled.getTimeOfEvent());
+
+	count++;
+
+	// Grow the calendar if there are too many events per day
+	if (count > 2 * buckets.size())
+		resize(2 * buckets.size());
+}
+
+Event CalendarQueueFEL::pop()
+{
+	// Search the days of the current year, starting at the current day
+	std::size_t n = buckets.size();
+	bool found = false;
+	for (std::size_t i = 0; i < n; ++i) {
+		const std::vector<Event> &bucket = buckets[current];
+		if (!bucket.empty() && dayOf(bucket.back().getTimeOfEvent()) <= currentDay) {
+			found = true;
+			break;
+		}
+
+		current = (current + 1 == n) ? 0 : current + 1;
+		currentDay++;
+	}
+
+	// If no event occurs within a year, jump directly to the event that is next to occur
+	if (!found) {
+		std::size_t best = n;
+		for (std::size_t b = 0; b < n; ++b) {
+			if (!buckets[b].empty() && (best == n || precedes(buckets[b].back(), buckets[best].back())))
+				best = b;
+		}
+		moveTo(buckets[best].back().getTimeOfEvent());
+	}
+
+	Event top = buckets[current].back();
+	buckets[current].pop_back();
+	count--;
+
+	// Shrink the calendar if there are too few events per day
+	if (buckets.size() > minBuckets && count < buckets.size() / 2)
+		resize(buckets.size() / 2);
+
+	return top;
+}
+
+void CalendarQueueFEL::removeAll()
+{
+	buckets.assign(minBuckets, std::vector<Event>());
+	width = 1.0;
+	current = 0;
+	currentDay = 0;
+	count = 0;
+}
+
+void CalendarQueueFEL::collect(std::vector<Event> &out) const
+{
+	for (std::size_t b = 0; b < buckets.size(); ++b)
+		out.insert(out.end(), buckets[b].begin(), buckets[b].end());
+}
+
+// Estimate the width of a day as three times the average separation of the events that are
+// next to occur, ignoring separations much larger than average (Brown, 1988).
+double CalendarQueueFEL::estimateWidth(std::vector<Event> &events) const
+{
+	std::size_t samples = std::min(events.size(), widthSampleSize);
+	if (samples < 2)
+		return width;
+
+	std::partial_sort(events.begin(), events.begin() + samples, events.end(), precedes);
+
+	double total = events[samples - 1].getTimeOfEvent() - events[0].getTimeOfEvent();
+	double average = total / (samples - 1);
+	if (average <= 0)
+		return width;
+
+	double trimmedTotal = 0;
+	std::size_t trimmedCount = 0;
+	for (std::size_t i = 1; i < samples; ++i) {
+		double separation = events[i].getTimeOfEvent() - events[i - 1].getTimeOfEvent();
+		if (separation <= 2 * average) {
+			trimmedTotal += separation;
+			trimmedCount++;
+		}
+	}
+
+	if (trimmedCount == 0 || trimmedTotal <= 0)
+		return 3 * average;
+
+	return 3 * trimmedTotal / trimmedCount;
+}
+
+// Rebuild the calendar with a new number of buckets and a new day width
+void CalendarQueueFEL::resize(std::size_t numBuckets)
+{
+	std::vector<Event> events;
+	events.reserve(count);
+	collect(events);
+
+	width = estimateWidth(events);
+	buckets.assign(numBuckets, std::vector<Event>());
+
+	// Insert the events in reverse order so that each bucket ends up sorted with
+	// the event that is next to occur at its back.
+	std::sort(events.begin(), events.end(), follows);
+	for (std::size_t i = 0; i < events.size(); ++i)
+		buckets[bucketOf(events[i].getTimeOfEvent())].push_back(events[i]);
+
+	if (!events.empty())
+		moveTo(events.back().getTimeOfEvent());
+	else {
+		current = 0;
+		currentDay = 0;
+	}
+}
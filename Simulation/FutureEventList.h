@@ -0,0 +1,309 @@
+// Header file for the Future Event List (FEL) classes
+#ifndef FUTURE_EVENT_LIST_H
+#define FUTURE_EVENT_LIST_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <unordered_map>
+
+#include "Event.h"
+
+// Backends that can be used to hold the Future Event List
+enum FELType {
+	FEL_BINARY_HEAP,     // Implicit binary heap (2-ary)
+	FEL_QUATERNARY_HEAP, // Implicit 4-ary heap (shallower, more cache friendly)
+	FEL_PAIRING_HEAP,    // Pairing heap with pooled nodes
+	FEL_CALENDAR_QUEUE   // Calendar queue (Brown, 1988). Amortized O(1) insert and pop.
+};
+
+// Convert a FEL type to a string and back. parseFELType returns false if the name is unknown.
+std::string felTypeToString(FELType);
+bool parseFELType(const std::string &, FELType &);
+
+// Returns true if event a must be executed before event b. The FEL gives each event a sequence
+// number that records the order in which events were scheduled, so events with equal times are
+// executed in the order in which they were scheduled (first in, first out).
+inline bool precedes(const Event &a, const Event &b)
+{
+	return a.precedes(b);
+}
+
+// Handle of a scheduled event, to cancel it: the number of events scheduled before it. Handles do not wrap
+// around. The low 24 bits are the sequence number the event is given (see Event::precedes), until it is
+// renumbered.
+typedef std::uint64_t EventHandle;
+
+// Abstract Future Event List. All backends give the same order of events: lowest time first,
+// and ties broken by the order of insertion.
+//
+// Events are cancelled lazily: a cancelled event stays in the backend and is dropped when it comes up
+// in popNext, so cancelling is O(1) with any backend. Until then it only takes room. To tell whether
+// a handle is still pending, the list keeps one bit per sequence number from the first cancel on; a
+// list in which nothing was cancelled pays one test of an empty vector per insert and popNext.
+//
+// Sequence numbers are 24 bits, so they wrap around. To keep them unique and in order among the events
+// held, every 2^21 inserts the list is rebuilt: the cancelled events are dropped, and the events scheduled
+// more than 2^21 inserts before (such as the end of simulation) are given new sequence numbers, in the
+// same order, just before those of the others. Their handles still cancel them. The order of events is
+// the order of scheduling as long as fewer than 2^22 events are pending.
+class FutureEventList {
+public:
+	FutureEventList() : nextHandle(0), lastRenumbering(0) {}
+	virtual ~FutureEventList() {}
+
+	// Schedule a new event and return its handle
+	EventHandle insert(const Event &event)
+	{
+		if ((nextHandle & (renumberingPeriod - 1)) == 0 && nextHandle > 0)
+			renumber();
+
+		Event scheduled = event;
+		scheduled.setSequence(static_cast<std::uint32_t>(nextHandle));
+		push(scheduled);
+		if (!pending.empty())
+			setPending(scheduled.getSequence(), true);
+		return nextHandle++;
+	}
+
+	// Cancel a pending event. Returns false, and does nothing, if the event was already executed or
+	// cancelled.
+	bool cancel(EventHandle);
+
+	// Move a pending event to another time (or change it): cancel it and schedule 'event' instead.
+	// Returns the handle of the new event.
+	EventHandle reschedule(EventHandle handle, const Event &event)
+	{
+		cancel(handle);
+		return insert(event);
+	}
+
+	// Remove and return the event that is next to occur, dropping the cancelled events before it. The list
+	// must not be empty.
+	Event popNext()
+	{
+		while (1) {
+			Event next = pop();
+			if (pending.empty())
+				return next;
+			if (cancelled.erase(next.getSequence()) == 0) {
+				setPending(next.getSequence(), false);
+				return next;
+			}
+		}
+	}
+
+	// Put back an event taken out by popNext and not executed, before any other event is scheduled. It keeps
+	// its sequence number, so its place among the events with the same time does not change.
+	void putBack(const Event &event)
+	{
+		push(event);
+		if (!pending.empty())
+			setPending(event.getSequence(), true);
+	}
+
+	// Remove all events and reset the handles
+	void clear()
+	{
+		nextHandle = 0;
+		lastRenumbering = 0;
+		cancelled.clear();
+		pending.clear();
+		renumbered.clear();
+		removeAll();
+	}
+
+	// Number of pending events, not counting the cancelled ones
+	bool empty() const { return size() == 0; }
+	std::size_t size() const { return stored() - cancelled.size(); }
+
+	// Returns a copy of all pending events in the order in which they will occur (for debugging)
+	std::vector<Event> pendingEvents() const;
+
+protected:
+	// Backend operations
+	virtual std::size_t stored() const = 0; // Number of events held, cancelled ones included
+	virtual void push(const Event &) = 0;
+	virtual Event pop() = 0;
+	virtual void removeAll() = 0;
+
+	// Append all pending events (in any order) to the vector
+	virtual void collect(std::vector<Event> &) const = 0;
+
+private:
+	// Number of sequence numbers (24 bits), and number of inserts between two renumberings
+	static const std::uint64_t numSequences = std::uint64_t(1) << 24;
+	static const std::uint64_t renumberingPeriod = std::uint64_t(1) << 21;
+
+	// Drop the cancelled events and give new sequence numbers to the events held since before the last
+	// renumbering
+	void renumber();
+
+	// Whether the event with a sequence number is held and not cancelled
+	bool isPending(std::uint32_t sequence) const { return (pending[sequence >> 6] >> (sequence & 63)) & 1; }
+	void setPending(std::uint32_t sequence, bool value)
+	{
+		std::uint64_t bit = std::uint64_t(1) << (sequence & 63);
+		pending[sequence >> 6] = value ? (pending[sequence >> 6] | bit) : (pending[sequence >> 6] & ~bit);
+	}
+
+	EventHandle nextHandle;
+	EventHandle lastRenumbering;                 // nextHandle at the last renumbering
+	std::unordered_set<std::uint32_t> cancelled; // Sequence numbers of the cancelled events still held by the backend
+	std::vector<std::uint64_t> pending;          // One bit per sequence number (2 MB), empty until the first cancel
+	std::unordered_map<EventHandle, std::uint32_t> renumbered; // New sequence numbers of the events renumbered last time
+};
+
+// Create a Future Event List with the specified backend
+std::unique_ptr<FutureEventList> createFutureEventList(FELType);
+
+//////////////////////////////////////////////////
+//                  d-ary heap                  //
+//////////////////////////////////////////////////
+
+// Implicit d-ary min-heap stored in a contiguous array. O(log n) insert and pop.
+template <int D>
+class DaryHeapFEL final : public FutureEventList {
+protected:
+	std::size_t stored() const { return heap.size(); }
+
+	void push(const Event &scheduled)
+	{
+		// Sift up: move parents down until the position of the new event is found
+		std::size_t pos = heap.size();
+		heap.push_back(scheduled);
+		while (pos > 0) {
+			std::size_t parent = (pos - 1) / D;
+			if (!precedes(scheduled, heap[parent]))
+				break;
+			heap[pos] = heap[parent];
+			pos = parent;
+		}
+		heap[pos] = scheduled;
+	}
+
+	Event pop()
+	{
+		Event top = heap.front();
+		Event last = heap.back();
+		heap.pop_back();
+
+		// Sift down the last element from the root
+		std::size_t n = heap.size();
+		std::size_t pos = 0;
+		while (n > 0) {
+			std::size_t first = pos * D + 1;
+			if (first >= n)
+				break;
+
+			// Find the child that is next to occur
+			std::size_t best = first;
+			std::size_t end = (first + D < n) ? first + D : n;
+			for (std::size_t child = first + 1; child < end; ++child) {
+				if (precedes(heap[child], heap[best]))
+					best = child;
+			}
+
+			if (!precedes(heap[best], last))
+				break;
+			heap[pos] = heap[best];
+			pos = best;
+		}
+		if (n > 0)
+			heap[pos] = last;
+
+		return top;
+	}
+
+	void removeAll() { heap.clear(); }
+
+	void collect(std::vector<Event> &out) const { out.insert(out.end(), heap.begin(), heap.end()); }
+
+private:
+	std::vector<Event> heap;
+};
+
+typedef DaryHeapFEL<2> BinaryHeapFEL;
+typedef DaryHeapFEL<4> QuaternaryHeapFEL;
+
+//////////////////////////////////////////////////
+//                 Pairing heap                 //
+//////////////////////////////////////////////////
+
+// Pairing heap. O(1) insert and amortized O(log n) pop. Nodes live in a pool and are
+// recycled through a free list, so there is no allocation once the pool has grown.
+class PairingHeapFEL final : public FutureEventList {
+public:
+	PairingHeapFEL();
+
+protected:
+	std::size_t stored() const { return count; }
+	void push(const Event &);
+	Event pop();
+	void removeAll();
+	void collect(std::vector<Event> &) const;
+
+private:
+	// Index used to indicate "no node"
+	static const int NIL = -1;
+
+	struct Node {
+		Event item;
+		int child;   // First child
+		int sibling; // Next sibling (also used as the link in the free list)
+	};
+
+	// Link two heaps and return the index of the new root
+	int meld(int, int);
+
+	std::vector<Node> nodes;
+	std::vector<int> pairs; // Scratch space used by pop()
+	int root;
+	int freeList;
+	std::size_t count;
+};
+
+//////////////////////////////////////////////////
+//                Calendar queue                //
+//////////////////////////////////////////////////
+
+// Calendar queue. Events are hashed into "days" (buckets) of a "year" by their time. Each bucket
+// is kept sorted with the next event at its back. The number of buckets and the width of each day
+// are adjusted as the list grows and shrinks, so that insert and pop are O(1) on average.
+class CalendarQueueFEL final : public FutureEventList {
+public:
+	CalendarQueueFEL();
+
+protected:
+	std::size_t stored() const { return count; }
+	void push(const Event &);
+	Event pop();
+	void removeAll();
+	void collect(std::vector<Event> &) const;
+
+private:
+	// Rebuild the calendar with a new number of buckets
+	void resize(std::size_t);
+
+	// Estimate a good width for a day from the events that are next to occur.
+	// The events are partially sorted in the process.
+	double estimateWidth(std::vector<Event> &) const;
+
+	// Index of the day and of the bucket holding a given time
+	long long dayOf(double) const;
+	std::size_t bucketOf(double) const;
+
+	// Move the current day to the one holding a given time
+	void moveTo(double);
+
+	std::vector<std::vector<Event> > buckets;
+	double width;          // Width of a day
+	std::size_t current;   // Current bucket
+	long long currentDay;  // Index of the current day
+	std::size_t count;
+};
+
+#endif /* FUTURE_EVENT_LIST_H */
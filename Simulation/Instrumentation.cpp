@@ -0,0 +1,141 @@
+// Definition of the instrumentation of the simulation engine
+
+#include "Instrumentation.h"
+
+#include <iomanip>
+
+#include "PlantModel.h"
+
+// Names of the event types in the summary
+static const char *const eventTypeNames[NUM_EVENT_TYPES] = { "None", "Arrival", "Departure", "End" };
+
+void LogHistogram::clear()
+{
+	for (int b = 0; b < numBuckets; ++b)
+		buckets[b] = 0;
+	count = 0;
+	total = 0;
+	maximum = 0;
+}
+
+void LogHistogram::merge(const LogHistogram &other)
+{
+	for (int b = 0; b < numBuckets; ++b)
+		buckets[b] += other.buckets[b];
+	count += other.count;
+	total += other.total;
+	if (other.maximum > maximum)
+		maximum = other.maximum;
+}
+
+// Upper bound of the bucket that holds the quantile q (0 < q <= 1) of the durations
+std::uint64_t LogHistogram::quantile(double q) const
+{
+	if (count == 0)
+		return 0;
+
+	// Rank of the quantile, starting at 1
+	std::uint64_t rank = static_cast<std::uint64_t>(q * count);
+	if (rank < 1)
+		rank = 1;
+
+	std::uint64_t seen = 0;
+	for (int b = 0; b < numBuckets; ++b) {
+		seen += buckets[b];
+		if (seen >= rank) {
+			std::uint64_t upper = (std::uint64_t(2) << b) - 1;
+			return upper < maximum ? upper : maximum;
+		}
+	}
+
+	return maximum;
+}
+
+// Clear all measurements of a model with 'numStations' stations
+void InstrumentationData::clear(std::size_t numStations)
+{
+	replications = 0;
+	events = 0;
+	for (int type = 0; type < NUM_EVENT_TYPES; ++type) {
+		eventCount[type] = 0;
+		handlerTime[type].clear();
+	}
+	nextEventTime.clear();
+	eventListTime.clear();
+	traceTime.clear();
+	maxFELSize = 0;
+	maxQueueLength.assign(numStations, 0);
+	wallTime = 0;
+}
+
+// Add the measurements of another replication. Maxima are the maxima over all replications.
+void InstrumentationData::merge(const InstrumentationData &other)
+{
+	if (maxQueueLength.size() < other.maxQueueLength.size())
+		maxQueueLength.resize(other.maxQueueLength.size(), 0);
+
+	replications += other.replications;
+	events += other.events;
+	for (int type = 0; type < NUM_EVENT_TYPES; ++type) {
+		eventCount[type] += other.eventCount[type];
+		handlerTime[type].merge(other.handlerTime[type]);
+	}
+	nextEventTime.merge(other.nextEventTime);
+	eventListTime.merge(other.eventListTime);
+	traceTime.merge(other.traceTime);
+	if (other.maxFELSize > maxFELSize)
+		maxFELSize = other.maxFELSize;
+	for (std::size_t s = 0; s < other.maxQueueLength.size(); ++s) {
+		if (other.maxQueueLength[s] > maxQueueLength[s])
+			maxQueueLength[s] = other.maxQueueLength[s];
+	}
+	wallTime += other.wallTime;
+}
+
+// One row of the table of durations
+static void writeHistogram(std::ostream &out, const std::string &name, const LogHistogram &histogram)
+{
+	out << "  " << std::left << std::setw(20) << name << std::right
+		<< std::setw(10) << histogram.size()
+		<< std::setw(10) << std::setprecision(1) << std::fixed << histogram.mean()
+		<< std::setw(10) << histogram.quantile(0.5)
+		<< std::setw(10) << histogram.quantile(0.99)
+		<< std::setw(12) << histogram.max() << std::endl;
+	out.unsetf(std::ios::fixed);
+	out << std::setprecision(6);
+}
+
+// Write a summary of the measurements, titled 'title', naming the stations of the model
+void writeInstrumentation(std::ostream &out, const std::string &title, const InstrumentationData &data, const PlantModel &model)
+{
+	out << title << std::endl;
+	out << "  Replications: " << data.replications << ", events: " << data.events << ", event loop: " << data.wallTime << " s";
+	if (data.wallTime > 0)
+		out << " (" << data.events / data.wallTime << " events/s)";
+	out << std::endl;
+
+	out << "  Events by type:";
+	for (int type = 0; type < NUM_EVENT_TYPES; ++type) {
+		if (data.eventCount[type] > 0)
+			out << " " << eventTypeNames[type] << " " << data.eventCount[type];
+	}
+	out << std::endl;
+
+	out << "  Sampled durations (ns), one event in " << Instrumentation::samplePeriod << ":" << std::endl;
+	out << "  " << std::left << std::setw(20) << "" << std::right << std::setw(10) << "Samples" << std::setw(10) << "Mean"
+		<< std::setw(10) << "p50 <=" << std::setw(10) << "p99 <=" << std::setw(12) << "Max" << std::endl;
+	writeHistogram(out, "Next event (FEL)", data.nextEventTime);
+	if (data.eventListTime.size() > 0)
+		writeHistogram(out, "Print FEL", data.eventListTime);
+	for (int type = 0; type < NUM_EVENT_TYPES; ++type) {
+		if (data.handlerTime[type].size() > 0)
+			writeHistogram(out, std::string(eventTypeNames[type]) + " handler", data.handlerTime[type]);
+	}
+	writeHistogram(out, "Event trace", data.traceTime);
+
+	out << "  Largest FEL: " << data.maxFELSize << " events" << std::endl;
+	out << "  Longest queues:";
+	for (std::size_t s = 0; s < data.maxQueueLength.size() && s < model.stations.size(); ++s)
+		out << " " << model.stations[s].name << " " << data.maxQueueLength[s];
+	out << std::endl << std::endl;
+}
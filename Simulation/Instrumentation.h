@@ -0,0 +1,166 @@
+// Header file for the instrumentation of the simulation engine
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Event.h"
+
+struct PlantModel;
+
+// The instrumentation is compiled in only when SIM_ENABLE_INSTRUMENTATION is defined to 1 (in CMake,
+// -DSIM_ENABLE_INSTRUMENTATION=ON; in Visual Studio, add it to the preprocessor definitions). Otherwise
+// Instrumentation::enabled is false and the engine's event loop has no instrumentation code left.
+#ifndef SIM_ENABLE_INSTRUMENTATION
+#define SIM_ENABLE_INSTRUMENTATION 0
+#endif
+
+// Histogram of durations in nanoseconds, with buckets of doubling width: bucket b holds the durations
+// in [2^b, 2^(b+1)) ns, and bucket 0 holds 0 and 1 ns. Histograms of different replications are merged
+// by adding their buckets.
+class LogHistogram {
+public:
+	static const int numBuckets = 40;
+
+	LogHistogram() { clear(); }
+
+	void clear();
+
+	void add(std::uint64_t nanoseconds)
+	{
+		int bucket = 0;
+		for (std::uint64_t x = nanoseconds >> 1; x != 0 && bucket < numBuckets - 1; x >>= 1)
+			bucket++;
+		buckets[bucket]++;
+		count++;
+		total += nanoseconds;
+		if (nanoseconds > maximum)
+			maximum = nanoseconds;
+	}
+
+	void merge(const LogHistogram &);
+
+	std::uint64_t size() const { return count; }
+	double mean() const { return count == 0 ? 0 : static_cast<double>(total) / count; }
+	std::uint64_t max() const { return maximum; }
+
+	// Upper bound of the bucket that holds the quantile q (0 < q <= 1) of the durations
+	std::uint64_t quantile(double q) const;
+
+private:
+	std::uint64_t buckets[numBuckets];
+	std::uint64_t count;
+	std::uint64_t total;
+	std::uint64_t maximum;
+};
+
+// What the instrumentation measured in one replication, or in several merged together
+struct InstrumentationData {
+	InstrumentationData() { clear(0); }
+
+	// Clear all measurements of a model with 'numStations' stations
+	void clear(std::size_t numStations);
+
+	// Add the measurements of another replication
+	void merge(const InstrumentationData &);
+
+	int replications;
+	unsigned long long events;
+	unsigned long long eventCount[NUM_EVENT_TYPES]; // Number of events executed of each type
+
+	// Sampled durations: taking the next event from the FEL, printing the FEL (TRACE_FULL only), the
+	// handler of each event type (which includes scheduling new events), and writing the event trace
+	LogHistogram nextEventTime;
+	LogHistogram eventListTime;
+	LogHistogram handlerTime[NUM_EVENT_TYPES];
+	LogHistogram traceTime;
+
+	std::size_t maxFELSize;                    // Largest number of pending events
+	std::vector<std::size_t> maxQueueLength;   // Largest number of entities waiting in the queue of each station
+	double wallTime;                           // Time spent in the event loop (secs)
+};
+
+// Write a summary of the measurements, titled 'title', naming the stations of the model
+void writeInstrumentation(std::ostream &, const std::string &title, const InstrumentationData &, const PlantModel &);
+
+// Measurements taken by the engine while it runs. Every event is counted, but only one event in
+// samplePeriod is timed, since reading the clock costs about as much as a short handler.
+class Instrumentation {
+public:
+	static const bool enabled = SIM_ENABLE_INSTRUMENTATION != 0;
+	static const unsigned samplePeriod = 16;
+
+	typedef std::chrono::steady_clock Clock;
+
+	// Start the measurements of a replication
+	void begin(std::size_t numStations)
+	{
+		data.clear(numStations);
+		data.replications = 1;
+		sampled = false;
+		start = Clock::now();
+	}
+
+	// Before taking the next event from a FEL of 'pending' events
+	void beforeNextEvent(std::size_t pending)
+	{
+		if (pending > data.maxFELSize)
+			data.maxFELSize = pending;
+		sampled = (data.events++ % samplePeriod) == 0;
+		if (sampled)
+			stamp = Clock::now();
+	}
+
+	// After taking the next event from the FEL
+	void afterNextEvent() { lap(data.nextEventTime); }
+
+	// After printing the FEL
+	void afterEventList() { lap(data.eventListTime); }
+
+	// After handling an event of type 'type'
+	void afterHandler(EventType type)
+	{
+		data.eventCount[type]++;
+		lap(data.handlerTime[type]);
+	}
+
+	// After writing the event trace
+	void afterTrace() { lap(data.traceTime); }
+
+	// An entity joined the queue of 'station', which now holds 'length' entities
+	void queueLength(int station, std::size_t length)
+	{
+		if (length > data.maxQueueLength[station])
+			data.maxQueueLength[station] = length;
+	}
+
+	// End the measurements of a replication and return them
+	const InstrumentationData &end()
+	{
+		data.wallTime = std::chrono::duration<double>(Clock::now() - start).count();
+		return data;
+	}
+
+private:
+	// Record the time since the last stamp in 'histogram' (if this event is timed), and stamp again
+	void lap(LogHistogram &histogram)
+	{
+		if (!sampled)
+			return;
+
+		Clock::time_point now = Clock::now();
+		histogram.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - stamp).count()));
+		stamp = now;
+	}
+
+	InstrumentationData data;
+	bool sampled;
+	Clock::time_point start;
+	Clock::time_point stamp;
+};
+
+#endif /* INSTRUMENTATION_H */
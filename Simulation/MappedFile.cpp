@@ -0,0 +1,138 @@
+// Definition of class MappedFile.
+
+// Include header file for class MappedFile
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Constructor
+MappedFile::MappedFile() : mapping(0), length(0), opened(false)
+{
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = 0;
+#endif
+}
+
+// Destructor
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+// Map a file (Windows)
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize)) {
+		close();
+		return false;
+	}
+	length = static_cast<std::size_t>(fileSize.QuadPart);
+	opened = true;
+
+	// An empty file cannot be mapped, but it is a valid (empty) file
+	if (length == 0)
+		return true;
+
+	mappingHandle = CreateFileMappingA(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+	if (mappingHandle == 0) {
+		close();
+		return false;
+	}
+
+	mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (mapping == 0) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+// Unmap the file (Windows)
+void MappedFile::close()
+{
+	if (mapping != 0)
+		UnmapViewOfFile(mapping);
+	if (mappingHandle != 0)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+
+	mapping = 0;
+	mappingHandle = 0;
+	fileHandle = INVALID_HANDLE_VALUE;
+	length = 0;
+	opened = false;
+}
+
+#else
+
+// Map a file (POSIX)
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		::close(fd);
+		return false;
+	}
+	length = static_cast<std::size_t>(status.st_size);
+	opened = true;
+
+	// An empty file cannot be mapped, but it is a valid (empty) file
+	if (length == 0) {
+		::close(fd);
+		return true;
+	}
+
+	void *address = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // The mapping stays valid after the file is closed
+	if (address == MAP_FAILED) {
+		length = 0;
+		opened = false;
+		return false;
+	}
+
+	// The file is read from front to back
+	madvise(address, length, MADV_SEQUENTIAL);
+
+	mapping = address;
+	return true;
+}
+
+// Unmap the file (POSIX)
+void MappedFile::close()
+{
+	if (mapping != 0)
+		munmap(mapping, length);
+
+	mapping = 0;
+	length = 0;
+	opened = false;
+}
+
+#endif
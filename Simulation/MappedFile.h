@@ -0,0 +1,40 @@
+// Header file for class MappedFile
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// A file mapped read-only into memory. The operating system pages the file in lazily as it is
+// read, so files much larger than RAM can be scanned without copying them.
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Map a file. Returns false if the file cannot be opened or mapped.
+	bool open(const std::string &path);
+
+	// Unmap the file
+	void close();
+
+	bool isOpen() const { return opened; }
+	const char *data() const { return static_cast<const char *>(mapping); }
+	std::size_t size() const { return length; }
+
+private:
+	// Not copyable
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+
+	void *mapping;
+	std::size_t length;
+	bool opened;
+
+#ifdef _WIN32
+	void *fileHandle;
+	void *mappingHandle;
+#endif
+};
+
+#endif /* MAPPED_FILE_H */
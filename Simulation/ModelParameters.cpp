@@ -0,0 +1,264 @@
+// Definition of the model parameters.
+
+#include <cmath> // std::floor
+
+// Include header file for the model parameters
+#include "ModelParameters.h"
+
+//////////////////////////////////////////////////
+//             User initializations             //
+//////////////////////////////////////////////////
+
+ModelParameters::ModelParameters()
+{
+	// Declare end of simulation time (mins)
+	endSimulationTime = 1080;
+
+	// Specify number of simulations to run
+	numSimulations = 10;
+
+	// Define ramp-up time. Only start recording statistics of interest after this ramp-up time.
+	rampUpTime = 120;
+
+	// Choose how the warm-up period is determined: WARMUP_FIXED uses the ramp-up time above, WARMUP_MSER5
+	// picks the warm-up period of each simulation from its own observations (the MSER-5 rule), recorded
+	// in buckets of warmUpBucketWidth minutes.
+	warmUpMethod = WARMUP_FIXED;
+	warmUpBucketWidth = 1;
+
+	// Choose whether confidence intervals are also computed from batch means within each simulation (for a
+	// single long simulation: set numSimulations to 1 and a long endSimulationTime). Batches start
+	// batchWidth minutes wide (0 for fixed batches), and at most maxBatches are kept by merging them.
+	batchMeans = false;
+	maxBatches = 64;
+	batchWidth = 60;
+	maxBatchAutocorrelation = 0.2;
+
+	// Specify the master seed of the random number streams. Simulation number i (starting at 0) uses
+	// replication i of every stream, so the same master seed always reproduces the same results.
+	masterSeed = 5200;
+
+	// Use antithetic pairs of simulations (variance reduction). Two scenarios run with the same master seed
+	// always use common random numbers: each stochastic source has its own stream (see RandomStream.h).
+	antitheticPairs = false;
+
+	// Declare service times and interarrival time means. These can be changed by the user here.
+	interArr_RodEnd = 5;
+	interArr_Piston = 5;
+	interArr_CylinderCap = 5;
+	interArr_Cylinder = 5;
+	interArr_CylinderRodEnd = 5;
+
+	srvcTime_Assembly_Mean = 4;
+	srvcTime_Assembly_Stdev = 1;
+
+	srvcTime_Coating_Mean = 5;
+	srvcTime_Coating_Stdev = 3;
+
+	srvcTime_Rework_Mean = 10;
+	srvcTime_Rework_Stdev = 4;
+
+	// Declare the number of servers of each station (e.g. coating booths working in parallel)
+	numServers_Assembly = 1;
+	numServers_Coating = 1;
+	numServers_Rework = 1;
+
+	// Define acceptance/rejection probabilities for each part.
+	accProb_RodEnd = 0.996;
+	accProb_Piston = 0.999;
+	accProb_CylinderCap = 1.0;
+	accProb_Cylinder = 0.999;
+	accProb_CylinderRodEnd = 0.998;
+
+	accProb_Assembly_NoRework = 0.868939;
+	accProb_Assembly_Rework = accProb_Assembly_NoRework*1.50;
+}
+
+//////////////////////////////////////////////////
+//              Inputs set by name              //
+//////////////////////////////////////////////////
+
+// Values that an input accepts
+enum ParameterRange {
+	RANGE_ANY,
+	RANGE_POSITIVE,     // Above 0 (times between events, lengths)
+	RANGE_NON_NEGATIVE, // 0 or above (service times, warm-up)
+	RANGE_PROBABILITY   // Between 0 and 1
+};
+
+// Inputs of type double, by name
+struct DoubleParameter {
+	const char *name;
+	double ModelParameters::*member;
+	ParameterRange range;
+};
+
+static const DoubleParameter doubleParameters[] = {
+	{ "endSimulationTime", &ModelParameters::endSimulationTime, RANGE_POSITIVE },
+	{ "rampUpTime", &ModelParameters::rampUpTime, RANGE_NON_NEGATIVE },
+	{ "warmUpBucketWidth", &ModelParameters::warmUpBucketWidth, RANGE_POSITIVE },
+	{ "batchWidth", &ModelParameters::batchWidth, RANGE_NON_NEGATIVE },
+	{ "maxBatchAutocorrelation", &ModelParameters::maxBatchAutocorrelation, RANGE_ANY },
+	{ "interArr_RodEnd", &ModelParameters::interArr_RodEnd, RANGE_POSITIVE },
+	{ "interArr_Piston", &ModelParameters::interArr_Piston, RANGE_POSITIVE },
+	{ "interArr_CylinderCap", &ModelParameters::interArr_CylinderCap, RANGE_POSITIVE },
+	{ "interArr_Cylinder", &ModelParameters::interArr_Cylinder, RANGE_POSITIVE },
+	{ "interArr_CylinderRodEnd", &ModelParameters::interArr_CylinderRodEnd, RANGE_POSITIVE },
+	{ "srvcTime_Assembly_Mean", &ModelParameters::srvcTime_Assembly_Mean, RANGE_NON_NEGATIVE },
+	{ "srvcTime_Assembly_Stdev", &ModelParameters::srvcTime_Assembly_Stdev, RANGE_NON_NEGATIVE },
+	{ "srvcTime_Coating_Mean", &ModelParameters::srvcTime_Coating_Mean, RANGE_NON_NEGATIVE },
+	{ "srvcTime_Coating_Stdev", &ModelParameters::srvcTime_Coating_Stdev, RANGE_NON_NEGATIVE },
+	{ "srvcTime_Rework_Mean", &ModelParameters::srvcTime_Rework_Mean, RANGE_NON_NEGATIVE },
+	{ "srvcTime_Rework_Stdev", &ModelParameters::srvcTime_Rework_Stdev, RANGE_NON_NEGATIVE },
+	{ "accProb_RodEnd", &ModelParameters::accProb_RodEnd, RANGE_PROBABILITY },
+	{ "accProb_Piston", &ModelParameters::accProb_Piston, RANGE_PROBABILITY },
+	{ "accProb_CylinderCap", &ModelParameters::accProb_CylinderCap, RANGE_PROBABILITY },
+	{ "accProb_Cylinder", &ModelParameters::accProb_Cylinder, RANGE_PROBABILITY },
+	{ "accProb_CylinderRodEnd", &ModelParameters::accProb_CylinderRodEnd, RANGE_PROBABILITY },
+	{ "accProb_Assembly_NoRework", &ModelParameters::accProb_Assembly_NoRework, RANGE_PROBABILITY },
+	{ "accProb_Assembly_Rework", &ModelParameters::accProb_Assembly_Rework, RANGE_NON_NEGATIVE } // Above 1 is taken as 1
+};
+
+static const int numDoubleParameters = sizeof(doubleParameters) / sizeof(doubleParameters[0]);
+
+// Check a value of an input of type double
+static bool inRange(ParameterRange range, double value, const std::string &name, std::string &error)
+{
+	if (value != value) {
+		error = name + " is not a number";
+		return false;
+	}
+
+	switch (range) {
+	case RANGE_POSITIVE:
+		if (value <= 0)
+			error = name + " must be positive";
+		break;
+	case RANGE_NON_NEGATIVE:
+		if (value < 0)
+			error = name + " must not be negative";
+		break;
+	case RANGE_PROBABILITY:
+		if (value < 0 || value > 1)
+			error = name + " must be between 0 and 1";
+		break;
+	default:
+		return true;
+	}
+
+	return error.empty();
+}
+
+// Set a model input by name
+bool setParameter(ModelParameters &params, const std::string &name, double value, std::string &error)
+{
+	error.clear();
+	for (int i = 0; i < numDoubleParameters; ++i) {
+		if (name == doubleParameters[i].name) {
+			if (!inRange(doubleParameters[i].range, value, name, error))
+				return false;
+			params.*doubleParameters[i].member = value;
+			return true;
+		}
+	}
+
+	if (value != value) {
+		error = name + " is not a number";
+		return false;
+	}
+
+	long long rounded = static_cast<long long>(std::floor(value + 0.5));
+	bool isFlag = (name == "warmUpMethod" || name == "antitheticPairs" || name == "batchMeans");
+	bool isServers = (name == "numServers_Assembly" || name == "numServers_Coating" || name == "numServers_Rework");
+	if (isFlag && rounded != 0 && rounded != 1)
+		error = name + " must be 0 or 1";
+	else if (isServers && (rounded < 1 || rounded > 65535))
+		error = name + " must be between 1 and 65535";
+	else if (name == "numSimulations" && rounded < 1)
+		error = name + " must be at least 1";
+	else if (name == "maxBatches" && rounded < 2)
+		error = name + " must be at least 2";
+	else if (name == "masterSeed" && rounded < 0)
+		error = name + " must not be negative";
+	if (!error.empty())
+		return false;
+
+	if (name == "numSimulations")
+		params.numSimulations = static_cast<int>(rounded);
+	else if (name == "numServers_Assembly")
+		params.numServers_Assembly = static_cast<int>(rounded);
+	else if (name == "numServers_Coating")
+		params.numServers_Coating = static_cast<int>(rounded);
+	else if (name == "numServers_Rework")
+		params.numServers_Rework = static_cast<int>(rounded);
+	else if (name == "masterSeed")
+		params.masterSeed = static_cast<unsigned long long>(rounded);
+	else if (name == "warmUpMethod")
+		params.warmUpMethod = (rounded == WARMUP_MSER5) ? WARMUP_MSER5 : WARMUP_FIXED;
+	else if (name == "antitheticPairs")
+		params.antitheticPairs = (rounded != 0);
+	else if (name == "batchMeans")
+		params.batchMeans = (rounded != 0);
+	else if (name == "maxBatches")
+		params.maxBatches = static_cast<int>(rounded);
+	else {
+		error = "unknown model input '" + name + "'";
+		return false;
+	}
+
+	return true;
+}
+
+// Get a model input by name
+bool getParameter(const ModelParameters &params, const std::string &name, double &value)
+{
+	for (int i = 0; i < numDoubleParameters; ++i) {
+		if (name == doubleParameters[i].name) {
+			value = params.*doubleParameters[i].member;
+			return true;
+		}
+	}
+
+	if (name == "numSimulations")
+		value = params.numSimulations;
+	else if (name == "numServers_Assembly")
+		value = params.numServers_Assembly;
+	else if (name == "numServers_Coating")
+		value = params.numServers_Coating;
+	else if (name == "numServers_Rework")
+		value = params.numServers_Rework;
+	else if (name == "masterSeed")
+		value = static_cast<double>(params.masterSeed);
+	else if (name == "warmUpMethod")
+		value = params.warmUpMethod;
+	else if (name == "antitheticPairs")
+		value = params.antitheticPairs ? 1 : 0;
+	else if (name == "batchMeans")
+		value = params.batchMeans ? 1 : 0;
+	else if (name == "maxBatches")
+		value = params.maxBatches;
+	else
+		return false;
+
+	return true;
+}
+
+// Names of all inputs that can be set by name
+std::vector<std::string> parameterNames()
+{
+	std::vector<std::string> names;
+	for (int i = 0; i < numDoubleParameters; ++i)
+		names.push_back(doubleParameters[i].name);
+
+	names.push_back("numSimulations");
+	names.push_back("numServers_Assembly");
+	names.push_back("numServers_Coating");
+	names.push_back("numServers_Rework");
+	names.push_back("masterSeed");
+	names.push_back("warmUpMethod");
+	names.push_back("antitheticPairs");
+	names.push_back("batchMeans");
+	names.push_back("maxBatches");
+
+	return names;
+}
@@ -0,0 +1,117 @@
+// Header file for the model parameters
+#ifndef MODEL_PARAMETERS_H
+#define MODEL_PARAMETERS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+struct PlantModel;
+
+// How the warm-up period of each simulation is chosen
+enum WarmUpMethod {
+	WARMUP_FIXED, // Statistics of interest are recorded after rampUpTime
+	WARMUP_MSER5  // The warm-up period of each simulation is chosen by the MSER-5 rule (see MSERStatistics)
+};
+
+// All inputs of the plant model. The constructor sets the reference values, which can be
+// changed by the user in ModelParameters.cpp.
+struct ModelParameters {
+	ModelParameters();
+
+	// End of simulation time (mins)
+	double endSimulationTime;
+
+	// Number of simulations to run
+	int numSimulations;
+
+	// Ramp-up time. Only start recording statistics of interest after this ramp-up time.
+	double rampUpTime;
+
+	// How the warm-up period is chosen. With WARMUP_MSER5, rampUpTime is not used.
+	WarmUpMethod warmUpMethod;
+
+	// Width of the time buckets in which observations are recorded for the MSER-5 rule (mins)
+	double warmUpBucketWidth;
+
+	// Batch means. If true, each simulation also cuts the time after rampUpTime into consecutive batches,
+	// so that confidence intervals can be computed from the batch means of a single long simulation (see
+	// BatchMeansStatistics). Memory does not grow with the length of the simulation. The warm-up is rampUpTime.
+	bool batchMeans;
+
+	// Number of batches kept (an even number). When they are all full, adjacent batches are merged in pairs,
+	// so the batch width doubles.
+	int maxBatches;
+
+	// Width of the first batches (mins). If 0, batches have the fixed width timeOfInterest() / maxBatches.
+	double batchWidth;
+
+	// At the end of the simulation, batches that are not fixed are merged in pairs while the lag-1 autocorrelation
+	// of the batch means of a statistic is above this limit (and at least minBatchMeans batches remain).
+	double maxBatchAutocorrelation;
+
+	// Master seed of the random number streams
+	unsigned long long masterSeed;
+
+	// Antithetic variates. If true, simulations 2i and 2i + 1 form a pair: simulation 2i + 1 uses the
+	// antithetic streams of simulation 2i, and the statistics of the pair are averaged into a single
+	// observation for the confidence intervals.
+	bool antitheticPairs;
+
+	// Random number streams used by simulation number 'replication' (starting at 0), and whether they are antithetic
+	unsigned streamReplication(int replication) const { return antitheticPairs ? replication / 2 : replication; }
+	bool antitheticReplication(int replication) const { return antitheticPairs && replication % 2 == 1; }
+
+	// Interarrival time means
+	double interArr_RodEnd;
+	double interArr_Piston;
+	double interArr_CylinderCap;
+	double interArr_Cylinder;
+	double interArr_CylinderRodEnd;
+
+	// Service times
+	double srvcTime_Assembly_Mean;
+	double srvcTime_Assembly_Stdev;
+
+	double srvcTime_Coating_Mean;
+	double srvcTime_Coating_Stdev;
+
+	double srvcTime_Rework_Mean;
+	double srvcTime_Rework_Stdev;
+
+	// Number of servers in parallel at each station
+	int numServers_Assembly;
+	int numServers_Coating;
+	int numServers_Rework;
+
+	// Acceptance/rejection probabilities for each part
+	double accProb_RodEnd;
+	double accProb_Piston;
+	double accProb_CylinderCap;
+	double accProb_Cylinder;
+	double accProb_CylinderRodEnd;
+
+	double accProb_Assembly_NoRework;
+	double accProb_Assembly_Rework;
+
+	// Plant simulated instead of the reference plant built from the inputs above (see PlantModel.h), or
+	// null for the reference plant. The model is shared, read-only, by all simulations.
+	std::shared_ptr<const PlantModel> plantModel;
+
+	// Time over which statistics are recorded
+	double timeOfInterest() const { return endSimulationTime - rampUpTime; }
+};
+
+// Set or get a model input by its name in ModelParameters (e.g. "srvcTime_Coating_Mean"), so that inputs
+// can be changed without rebuilding (see the Experiment tool). Integer, enum and bool inputs are set from
+// the nearest integer (0 is false). Both return false if the name is unknown. setParameter also returns
+// false, with a message and without changing the input, if the value is out of range: times between
+// arrivals and the end of simulation must be positive, other times not negative, probabilities between
+// 0 and 1, numbers of servers between 1 and 65535, and enum and bool inputs 0 or 1.
+bool setParameter(ModelParameters &, const std::string &name, double value, std::string &error);
+bool getParameter(const ModelParameters &, const std::string &name, double &value);
+
+// Names of all inputs that can be set by name
+std::vector<std::string> parameterNames();
+
+#endif /* MODEL_PARAMETERS_H */
@@ -0,0 +1,494 @@
+// Definition of the output analysis of replications.
+
+#include <cmath>  // std::sqrt, std::lgamma, std::exp, std::log, std::fabs, std::isfinite
+#include <limits> // std::numeric_limits
+#include <algorithm> // std::min
+
+// Include header file for the output analysis
+#include "OutputAnalysis.h"
+
+// Name of a statistic of interest
+std::string metricToString(ResultMetric metric)
+{
+	switch (metric) {
+	case METRIC_ASSEMBLIES_CREATED:
+		return "Assemblies Created";
+	case METRIC_ASSEMBLIES_DELIVERED:
+		return "Assemblies Delivered";
+	case METRIC_TIME_IN_SYSTEM:
+		return "Average Assembly Time in System";
+	case METRIC_NUM_IN_SYSTEM:
+		return "Average Num Assemblies in System";
+	case METRIC_ASSEMBLY_BUSY:
+		return "Prop. Assembly St. Busy";
+	case METRIC_REWORK_BUSY:
+		return "Prop. Rework Busy";
+	default:
+		break;
+	}
+
+	return "Error";
+}
+
+// Name of the utilization of a station of the model
+std::string stationMetricToString(const PlantModel &model, int station)
+{
+	return "Prop. " + model.stations[station].name + " Busy";
+}
+
+// Value of a statistic of interest in the result of a replication
+double metricValue(const ReplicationResult &result, ResultMetric metric, int station)
+{
+	switch (metric) {
+	case METRIC_ASSEMBLIES_CREATED:
+		return result.totalAssembliesCreated;
+	case METRIC_ASSEMBLIES_DELIVERED:
+		return result.totalAssembliesDelivered;
+	case METRIC_TIME_IN_SYSTEM:
+		return result.averageTimeInSystem;
+	case METRIC_NUM_IN_SYSTEM:
+		return result.averageNumInSystem;
+	case METRIC_ASSEMBLY_BUSY:
+		return result.propAssemblyBusy;
+	case METRIC_REWORK_BUSY:
+		return result.propReWorkBusy;
+	case METRIC_STATION_BUSY:
+		if (station >= 0 && station < static_cast<int>(result.stationUtilization.size()))
+			return result.stationUtilization[station];
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////
+//           Student t distribution             //
+//////////////////////////////////////////////////
+
+// Continued fraction of the regularized incomplete beta function (modified Lentz's method)
+static double betaContinuedFraction(double a, double b, double x)
+{
+	const double tiny = 1e-300;
+	const double epsilon = 1e-15;
+
+	double c = 1;
+	double d = 1 - (a + b) * x / (a + 1);
+	if (std::fabs(d) < tiny)
+		d = tiny;
+	d = 1 / d;
+	double f = d;
+
+	for (int m = 1; m <= 300; ++m) {
+		// Even step
+		double numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+		d = 1 + numerator * d;
+		if (std::fabs(d) < tiny)
+			d = tiny;
+		c = 1 + numerator / c;
+		if (std::fabs(c) < tiny)
+			c = tiny;
+		d = 1 / d;
+		f *= d * c;
+
+		// Odd step
+		numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+		d = 1 + numerator * d;
+		if (std::fabs(d) < tiny)
+			d = tiny;
+		c = 1 + numerator / c;
+		if (std::fabs(c) < tiny)
+			c = tiny;
+		d = 1 / d;
+		double delta = d * c;
+		f *= delta;
+
+		if (std::fabs(delta - 1) < epsilon)
+			break;
+	}
+
+	return f;
+}
+
+// Regularized incomplete beta function I_x(a, b)
+static double incompleteBeta(double a, double b, double x)
+{
+	if (x <= 0)
+		return 0;
+	if (x >= 1)
+		return 1;
+
+	double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1 - x));
+
+	// The continued fraction converges quickly for x < (a + 1) / (a + b + 2); use the symmetry otherwise
+	if (x < (a + 1) / (a + b + 2))
+		return front * betaContinuedFraction(a, b, x) / a;
+
+	return 1 - front * betaContinuedFraction(b, a, 1 - x) / b;
+}
+
+// Cumulative distribution function of the Student t distribution
+static double studentTCdf(double t, int dof)
+{
+	double v = dof;
+	double tail = 0.5 * incompleteBeta(v / 2, 0.5, v / (v + t * t)); // P(T > |t|)
+
+	return (t >= 0) ? 1 - tail : tail;
+}
+
+// Quantile of the Student t distribution, found by bisection on the distribution function
+double studentTQuantile(double p, int dof)
+{
+	if (dof < 1 || p <= 0 || p >= 1)
+		return std::numeric_limits<double>::quiet_NaN();
+
+	// The distribution is symmetric about 0
+	if (p < 0.5)
+		return -studentTQuantile(1 - p, dof);
+
+	double low = 0;
+	double high = 1;
+	while (studentTCdf(high, dof) < p)
+		high *= 2;
+
+	for (int i = 0; i < 200 && high - low > 1e-12 * high; ++i) {
+		double middle = 0.5 * (low + high);
+		if (studentTCdf(middle, dof) < p)
+			low = middle;
+		else
+			high = middle;
+	}
+
+	return 0.5 * (low + high);
+}
+
+//////////////////////////////////////////////////
+//             Warm-up truncation               //
+//////////////////////////////////////////////////
+
+// MSER-m truncation point of a time series
+std::size_t mserTruncation(const std::vector<double> &series, std::size_t batchSize)
+{
+	std::size_t k = series.size() / batchSize;
+	if (k < 2)
+		return 0;
+
+	// Batch means
+	std::vector<double> batchMeans(k, 0.0);
+	for (std::size_t j = 0; j < k; ++j) {
+		for (std::size_t i = 0; i < batchSize; ++i)
+			batchMeans[j] += series[j * batchSize + i];
+		batchMeans[j] /= batchSize;
+	}
+
+	// Walk back from the end of the series, keeping the sums of the batch means and of their
+	// squares over batches d, ..., k - 1
+	double sum = 0;
+	double sumSquares = 0;
+	std::size_t best = k - 1;
+	double bestStatistic = std::numeric_limits<double>::infinity();
+	for (std::size_t d = k; d-- > 0;) {
+		sum += batchMeans[d];
+		sumSquares += batchMeans[d] * batchMeans[d];
+
+		if (d > k / 2)
+			continue;
+
+		double m = static_cast<double>(k - d);
+		double sse = sumSquares - sum * sum / m;
+		double statistic = (sse > 0 ? sse : 0) / (m * m);
+		if (statistic <= bestStatistic) {
+			bestStatistic = statistic;
+			best = d;
+		}
+	}
+
+	return best * batchSize;
+}
+
+//////////////////////////////////////////////////
+//                 Batch means                  //
+//////////////////////////////////////////////////
+
+// Lag-1 autocorrelation of a series of observations
+double lag1Autocorrelation(const std::vector<double> &series)
+{
+	std::size_t n = series.size();
+	if (n < 3)
+		return 0;
+
+	double mean = 0;
+	for (std::size_t i = 0; i < n; ++i)
+		mean += series[i];
+	mean /= n;
+
+	double variance = 0;
+	double covariance = 0;
+	for (std::size_t i = 0; i < n; ++i) {
+		variance += (series[i] - mean) * (series[i] - mean);
+		if (i + 1 < n)
+			covariance += (series[i] - mean) * (series[i + 1] - mean);
+	}
+
+	return (variance > 0) ? covariance / variance : 0;
+}
+
+// Confidence interval of a steady-state mean from batch means
+BatchMeansInterval batchMeansInterval(const std::vector<double> &batchMeans, double confidence)
+{
+	std::vector<double> values;
+	RunningStatistics statistics;
+	for (std::size_t b = 0; b < batchMeans.size(); ++b) {
+		if (std::isfinite(batchMeans[b])) {
+			values.push_back(batchMeans[b]);
+			statistics.add(batchMeans[b]);
+		}
+	}
+
+	BatchMeansInterval interval;
+	interval.mean = statistics.mean();
+	interval.halfWidth = statistics.halfWidth(confidence);
+	interval.numBatches = static_cast<int>(statistics.count());
+	interval.lag1Autocorrelation = lag1Autocorrelation(values);
+	return interval;
+}
+
+// Names of the statistics of a BatchMeansSeries
+std::vector<std::string> batchMeansNames(const PlantModel &model)
+{
+	std::vector<std::string> names;
+	names.push_back("Assembly Time in System");
+	names.push_back("Average Num Assemblies in System");
+	for (std::size_t s = 0; s < model.stations.size(); ++s)
+		names.push_back("Prop. " + model.stations[s].name + " Busy");
+	return names;
+}
+
+void writeBatchMeansHeader(std::ostream &out, double confidence)
+{
+	out << "Simulation Number" << "," << "Statistic" << "," << "Batches" << "," << "Batch Width" << "," << "Mean" << "," <<
+		"Half-Width (" << confidence * 100 << "%)" << "," << "CI Low" << "," << "CI High" << "," << "Lag-1 Autocorrelation" << std::endl;
+}
+
+void writeBatchMeans(std::ostream &out, int simulation, const ReplicationResult &result, const PlantModel &model, double confidence)
+{
+	std::vector<std::string> names = batchMeansNames(model);
+	for (std::size_t m = 0; m < result.batchMeans.means.size() && m < names.size(); ++m) {
+		BatchMeansInterval interval = batchMeansInterval(result.batchMeans.means[m], confidence);
+		double h = interval.halfWidth;
+
+		out << simulation << "," << names[m] << "," << interval.numBatches << "," << result.batchMeans.batchWidth << "," <<
+			interval.mean << "," << h << "," << interval.mean - h << "," << interval.mean + h << "," <<
+			interval.lag1Autocorrelation << std::endl;
+	}
+}
+
+//////////////////////////////////////////////////
+//              RunningStatistics               //
+//////////////////////////////////////////////////
+
+double RunningStatistics::stdev() const
+{
+	return std::sqrt(variance());
+}
+
+// Half-width of the Student t confidence interval of the mean
+double RunningStatistics::halfWidth(double confidence) const
+{
+	if (n < 2)
+		return std::numeric_limits<double>::infinity();
+
+	return studentTQuantile(0.5 + confidence / 2, n - 1) * stdev() / std::sqrt(static_cast<double>(n));
+}
+
+//////////////////////////////////////////////////
+//            ReplicationStatistics             //
+//////////////////////////////////////////////////
+
+// Difference b - a of every statistic of interest of two replications
+ReplicationResult resultDifference(const ReplicationResult &a, const ReplicationResult &b)
+{
+	ReplicationResult difference;
+	difference.simulationNumber = a.simulationNumber;
+	difference.totalAssembliesCreated = b.totalAssembliesCreated - a.totalAssembliesCreated;
+	difference.totalAssembliesDelivered = b.totalAssembliesDelivered - a.totalAssembliesDelivered;
+	difference.averageTimeInSystem = b.averageTimeInSystem - a.averageTimeInSystem;
+	difference.averageNumInSystem = b.averageNumInSystem - a.averageNumInSystem;
+	difference.propAssemblyBusy = b.propAssemblyBusy - a.propAssemblyBusy;
+	difference.propReWorkBusy = b.propReWorkBusy - a.propReWorkBusy;
+	difference.warmUpTime = b.warmUpTime - a.warmUpTime;
+
+	if (a.stationUtilization.size() == b.stationUtilization.size()) {
+		difference.stationUtilization.resize(a.stationUtilization.size());
+		for (std::size_t s = 0; s < a.stationUtilization.size(); ++s)
+			difference.stationUtilization[s] = b.stationUtilization[s] - a.stationUtilization[s];
+	}
+	if (a.serverUtilization.size() == b.serverUtilization.size()) {
+		difference.serverUtilization.resize(a.serverUtilization.size());
+		for (std::size_t s = 0; s < a.serverUtilization.size(); ++s)
+			difference.serverUtilization[s] = b.serverUtilization[s] - a.serverUtilization[s];
+	}
+
+	return difference;
+}
+
+// Constructor
+ReplicationStatistics::ReplicationStatistics(int size) : groupSize(size > 1 ? size : 1), inGroup(0)
+{
+	for (int metric = 0; metric < NUM_METRICS; ++metric)
+		groupSums[metric] = 0;
+}
+
+// Add the result of a replication. The average of a group is added once the group is complete.
+void ReplicationStatistics::add(const ReplicationResult &result)
+{
+	timeInSystem.merge(result.timeInSystemDistribution);
+	rework.merge(result.reworkDistribution);
+	if (waitingTimes.size() < result.waitingTimeDistribution.size())
+		waitingTimes.resize(result.waitingTimeDistribution.size());
+	for (std::size_t s = 0; s < result.waitingTimeDistribution.size(); ++s)
+		waitingTimes[s].merge(result.waitingTimeDistribution[s]);
+
+	for (int metric = 0; metric < NUM_METRICS; ++metric)
+		groupSums[metric] += metricValue(result, static_cast<ResultMetric>(metric));
+	if (stationBusy.size() < result.stationUtilization.size()) {
+		stationBusy.resize(result.stationUtilization.size());
+		stationGroupSums.resize(result.stationUtilization.size(), 0.0);
+	}
+	for (std::size_t s = 0; s < result.stationUtilization.size(); ++s)
+		stationGroupSums[s] += result.stationUtilization[s];
+
+	if (++inGroup < groupSize)
+		return;
+
+	for (int metric = 0; metric < NUM_METRICS; ++metric) {
+		metrics[metric].add(groupSums[metric] / groupSize);
+		groupSums[metric] = 0;
+	}
+	for (std::size_t s = 0; s < stationBusy.size(); ++s) {
+		stationBusy[s].add(stationGroupSums[s] / groupSize);
+		stationGroupSums[s] = 0;
+	}
+	inGroup = 0;
+}
+
+// Returns true if the confidence interval of a statistic is narrow enough. The utilization of a station the
+// replications do not have never is.
+bool ReplicationStatistics::meets(const PrecisionTarget &target, double confidence) const
+{
+	if (target.metric == METRIC_STATION_BUSY && (target.station < 0 || target.station >= numStations()))
+		return false;
+
+	const RunningStatistics &statistic = (target.metric == METRIC_STATION_BUSY) ? stationBusy[target.station] :
+		metrics[target.metric];
+	double limit = target.relative ? target.halfWidth * std::fabs(statistic.mean()) : target.halfWidth;
+
+	return statistic.halfWidth(confidence) <= limit;
+}
+
+// Returns true if the replications so far satisfy the stopping rule. The minimum counts replications, not
+// groups of replications.
+bool ReplicationStatistics::meets(const StoppingRule &rule) const
+{
+	if (replications() < rule.minReplications)
+		return false;
+
+	for (std::size_t i = 0; i < rule.targets.size(); ++i) {
+		if (!meets(rule.targets[i], rule.confidence))
+			return false;
+	}
+
+	return true;
+}
+
+// Write one row of the summary of a statistic
+static void writeSummaryRow(std::ostream &out, const std::string &name, const RunningStatistics &statistic, double confidence)
+{
+	double h = statistic.halfWidth(confidence);
+
+	out << name << "," << statistic.count() << "," << statistic.mean() << "," << statistic.stdev() << "," << h << "," <<
+		statistic.mean() - h << "," << statistic.mean() + h << std::endl;
+}
+
+// Write the mean, standard deviation and confidence interval of each statistic, then of the utilization of
+// each station (CSV)
+void ReplicationStatistics::writeSummary(std::ostream &out, double confidence, const PlantModel &model) const
+{
+	out << "Statistic" << "," << "Replications" << "," << "Mean" << "," << "Std. Dev." << "," <<
+		"Half-Width (" << confidence * 100 << "%)" << "," << "CI Low" << "," << "CI High" << std::endl;
+
+	for (int metric = 0; metric < NUM_METRICS; ++metric)
+		writeSummaryRow(out, metricToString(static_cast<ResultMetric>(metric)), metrics[metric], confidence);
+	for (int s = 0; s < numStations() && s < static_cast<int>(model.stations.size()); ++s)
+		writeSummaryRow(out, stationMetricToString(model, s), stationBusy[s], confidence);
+}
+
+// Write one row of the quantiles of a distribution. A distribution without observations (e.g. with the
+// MSER-5 warm-up, which records none) has empty cells rather than quantiles of 0.
+static void writeQuantileRow(std::ostream &out, const std::string &name, const QuantileSketch &sketch)
+{
+	out << name << "," << sketch.size();
+	if (sketch.empty()) {
+		out << ",,,,,," << std::endl;
+		return;
+	}
+	out << "," << sketch.mean() << "," << sketch.quantile(0.5) << "," << sketch.quantile(0.9) << "," <<
+		sketch.quantile(0.95) << "," << sketch.quantile(0.99) << "," << sketch.max() << std::endl;
+}
+
+// Write the mean and quantiles of each distribution (CSV)
+void ReplicationStatistics::writeQuantiles(std::ostream &out, const PlantModel &model) const
+{
+	out << "Distribution" << "," << "Observations" << "," << "Mean" << "," << "p50" << "," << "p90" << "," << "p95" << "," <<
+		"p99" << "," << "Max" << std::endl;
+
+	writeQuantileRow(out, "Time in System per Assembly Delivered", timeInSystem);
+	writeQuantileRow(out, "Rework Loops", rework);
+	for (std::size_t s = 0; s < waitingTimes.size() && s < model.stations.size(); ++s)
+		writeQuantileRow(out, model.stations[s].name + " Waiting Time", waitingTimes[s]);
+}
+
+//////////////////////////////////////////////////
+//              PairedComparison                //
+//////////////////////////////////////////////////
+
+// Add the results of replication i of both scenarios
+void PairedComparison::add(const ReplicationResult &resultA, const ReplicationResult &resultB)
+{
+	a.add(resultA);
+	b.add(resultB);
+	difference.add(resultDifference(resultA, resultB));
+}
+
+// Write one row of the comparison of a statistic
+static void writeComparisonRow(std::ostream &out, const std::string &name, const RunningStatistics &a, const RunningStatistics &b,
+	const RunningStatistics &d, double confidence)
+{
+	double h = d.halfWidth(confidence);
+	bool significant = (d.mean() - h > 0) || (d.mean() + h < 0);
+
+	out << name << "," << d.count() << "," << a.mean() << "," << b.mean() << "," << d.mean() << "," << d.stdev() << "," << h << "," <<
+		d.mean() - h << "," << d.mean() + h << "," << (significant ? "Yes" : "No") << std::endl;
+}
+
+// Write the means of both scenarios and the confidence interval of their difference, for each statistic and
+// the utilization of each station (CSV). A difference is significant if its confidence interval does not contain 0.
+void PairedComparison::writeSummary(std::ostream &out, double confidence, const PlantModel &model) const
+{
+	out << "Statistic" << "," << "Pairs" << "," << "Mean A" << "," << "Mean B" << "," << "Mean Difference (B - A)" << "," <<
+		"Std. Dev. of Difference" << "," << "Half-Width (" << confidence * 100 << "%)" << "," << "CI Low" << "," << "CI High" << "," <<
+		"Significant" << std::endl;
+
+	for (int m = 0; m < NUM_METRICS; ++m) {
+		ResultMetric metric = static_cast<ResultMetric>(m);
+		writeComparisonRow(out, metricToString(metric), a[metric], b[metric], difference[metric], confidence);
+	}
+
+	// The utilization of the stations both scenarios have (with a different plant, none of them)
+	int numStations = std::min(std::min(a.numStations(), b.numStations()), difference.numStations());
+	for (int s = 0; s < numStations && s < static_cast<int>(model.stations.size()); ++s) {
+		writeComparisonRow(out, stationMetricToString(model, s), a.stationUtilization(s), b.stationUtilization(s),
+			difference.stationUtilization(s), confidence);
+	}
+}
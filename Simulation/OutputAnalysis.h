@@ -0,0 +1,203 @@
+// Header file for the output analysis of replications
+#ifndef OUTPUT_ANALYSIS_H
+#define OUTPUT_ANALYSIS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "QuantileSketch.h"
+#include "Simulation.h"
+
+// Statistics of interest of a replication (the columns of Simulation_Results.csv)
+enum ResultMetric {
+	METRIC_ASSEMBLIES_CREATED,
+	METRIC_ASSEMBLIES_DELIVERED,
+	METRIC_TIME_IN_SYSTEM,
+	METRIC_NUM_IN_SYSTEM,
+	METRIC_ASSEMBLY_BUSY,
+	METRIC_REWORK_BUSY,
+	NUM_METRICS,
+
+	// Proportion of time the servers of a station were busy, for any station of the model, given by its
+	// index. Not one of the NUM_METRICS statistics above, which are the same for every model.
+	METRIC_STATION_BUSY = NUM_METRICS
+};
+
+// Name of a statistic of interest, as in the header of Simulation_Results.csv
+std::string metricToString(ResultMetric);
+
+// Name of the utilization of a station of the model ("Prop. <station> Busy")
+std::string stationMetricToString(const PlantModel &, int station);
+
+// Value of a statistic of interest in the result of a replication. The station is only used by
+// METRIC_STATION_BUSY (0 if the replication has no such station).
+double metricValue(const ReplicationResult &, ResultMetric, int station = -1);
+
+// Quantile of the Student t distribution with 'dof' degrees of freedom: the value t such that P(T <= t) = p
+double studentTQuantile(double p, int dof);
+
+// MSER-m truncation point of a time series (White, 1997). The series is grouped in batches of 'batchSize'
+// observations, and the number of batches d that minimizes the marginal standard error
+// sum_{j>=d} (Y_j - mean_d)^2 / (k - d)^2 over the batch means Y_j is chosen, with d at most half of the
+// k batches. Returns the number of observations to discard (a multiple of batchSize).
+std::size_t mserTruncation(const std::vector<double> &series, std::size_t batchSize = 5);
+
+// Lag-1 autocorrelation of a series of observations (0 with fewer than 3 observations)
+double lag1Autocorrelation(const std::vector<double> &series);
+
+// Confidence interval of a steady-state mean from the batch means of a single simulation. The batch means
+// are taken as independent observations, which holds if the batches are long enough: a lag-1
+// autocorrelation close to 0 is a sign that they are. Batches without a value (NaN) are left out.
+struct BatchMeansInterval {
+	double mean;
+	double halfWidth;
+	int numBatches;
+	double lag1Autocorrelation;
+};
+
+BatchMeansInterval batchMeansInterval(const std::vector<double> &batchMeans, double confidence);
+
+// Names of the statistics of a BatchMeansSeries of a model
+std::vector<std::string> batchMeansNames(const PlantModel &);
+
+// Write the header, and the confidence intervals from the batch means of simulation number 'simulation' (CSV)
+void writeBatchMeansHeader(std::ostream &, double confidence);
+void writeBatchMeans(std::ostream &, int simulation, const ReplicationResult &, const PlantModel &, double confidence);
+
+// Mean and variance of a sequence of observations, updated one observation at a time
+// with Welford's algorithm (numerically stable, no need to keep the observations).
+class RunningStatistics {
+public:
+	RunningStatistics() : n(0), m(0), m2(0) {}
+
+	void add(double x)
+	{
+		n++;
+		double delta = x - m;
+		m += delta / n;
+		m2 += delta * (x - m);
+	}
+
+	int count() const { return n; }
+	double mean() const { return m; }
+
+	// Sample variance (0 with fewer than 2 observations)
+	double variance() const { return (n > 1) ? m2 / (n - 1) : 0; }
+	double stdev() const;
+
+	// Half-width of the Student t confidence interval of the mean at the given confidence level
+	// (e.g. 0.95). Infinite with fewer than 2 observations.
+	double halfWidth(double confidence) const;
+
+private:
+	int n;
+	double m;  // Mean
+	double m2; // Sum of squared differences from the mean
+};
+
+// Required precision of the confidence interval of a statistic of interest. The half-width must be
+// at most 'halfWidth', either in the units of the statistic or, if 'relative' is true, as a fraction
+// of the absolute value of its mean (e.g. 0.02 for +/- 2%). The station is that of METRIC_STATION_BUSY.
+struct PrecisionTarget {
+	PrecisionTarget(ResultMetric m, double h, bool r, int s = -1) : metric(m), station(s), halfWidth(h), relative(r) {}
+
+	ResultMetric metric;
+	int station;
+	double halfWidth;
+	bool relative;
+};
+
+// Sequential stopping rule: replications are run until every precision target is met, with at least
+// minReplications and at most maxReplications replications. Both count single replications, also with
+// antithetic pairs, where each pair is a single observation of the confidence intervals (so a pair counts
+// as 2 replications, and an even minimum and maximum are best).
+struct StoppingRule {
+	StoppingRule() : confidence(0.95), minReplications(10), maxReplications(1000) {}
+
+	double confidence;
+	int minReplications;
+	int maxReplications;
+	std::vector<PrecisionTarget> targets;
+};
+
+// Difference b - a of every statistic of interest of two replications
+ReplicationResult resultDifference(const ReplicationResult &a, const ReplicationResult &b);
+
+// Running statistics of all statistics of interest over the replications. With a group size larger
+// than 1, consecutive groups of replications (e.g. antithetic pairs) are averaged, and each group is
+// a single observation. The distributions of the replications (time in system, rework loops and waiting
+// times) are merged, for quantiles over all of them.
+class ReplicationStatistics {
+public:
+	explicit ReplicationStatistics(int groupSize = 1);
+
+	void add(const ReplicationResult &);
+
+	// Number of observations (groups of replications)
+	int count() const { return metrics[0].count(); }
+	const RunningStatistics &operator[](ResultMetric metric) const { return metrics[metric]; }
+
+	// Number of replications added, including those of an incomplete group
+	int replications() const { return count() * groupSize + inGroup; }
+
+	// Utilization of each station of the model (METRIC_STATION_BUSY)
+	int numStations() const { return static_cast<int>(stationBusy.size()); }
+	const RunningStatistics &stationUtilization(int station) const { return stationBusy[station]; }
+
+	// Returns true if the confidence interval of a statistic is narrow enough
+	bool meets(const PrecisionTarget &, double confidence) const;
+
+	// Returns true if the replications so far satisfy the stopping rule
+	bool meets(const StoppingRule &) const;
+
+	// Write the mean, standard deviation and confidence interval of each statistic, then of the utilization
+	// of each station of the model (CSV)
+	void writeSummary(std::ostream &, double confidence, const PlantModel &) const;
+
+	// Distributions of all replications merged together
+	const QuantileSketch &timeInSystemDistribution() const { return timeInSystem; }
+
+	// Write the mean and quantiles of each distribution, naming the stations of the model (CSV). The cells of
+	// a distribution without observations are empty.
+	void writeQuantiles(std::ostream &, const PlantModel &) const;
+
+private:
+	RunningStatistics metrics[NUM_METRICS];
+
+	QuantileSketch timeInSystem;
+	QuantileSketch rework;
+	std::vector<QuantileSketch> waitingTimes;
+
+	int groupSize;
+	int inGroup;                  // Number of replications of the current group added so far
+	double groupSums[NUM_METRICS];
+
+	std::vector<RunningStatistics> stationBusy;
+	std::vector<double> stationGroupSums;
+};
+
+// Paired-difference confidence intervals of two scenarios (A and B). Replication i of both scenarios
+// must use the same random numbers (common random numbers), so that the differences B - A of the
+// statistics of interest have a much smaller variance than the statistics themselves.
+class PairedComparison {
+public:
+	explicit PairedComparison(int groupSize = 1) : a(groupSize), b(groupSize), difference(groupSize) {}
+
+	// Add the results of replication i of both scenarios
+	void add(const ReplicationResult &resultA, const ReplicationResult &resultB);
+
+	int count() const { return difference.count(); }
+	const RunningStatistics &operator[](ResultMetric metric) const { return difference[metric]; }
+
+	// Write the means of both scenarios and the confidence interval of their difference, for each statistic
+	// and for the utilization of each station of the model (CSV)
+	void writeSummary(std::ostream &, double confidence, const PlantModel &) const;
+
+private:
+	ReplicationStatistics a;
+	ReplicationStatistics b;
+	ReplicationStatistics difference;
+};
+
+#endif /* OUTPUT_ANALYSIS_H */
@@ -0,0 +1,382 @@
+// Header file for class template ParallelSimulationEngine
+#ifndef PARALLEL_ENGINE_H
+#define PARALLEL_ENGINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Event.h"
+#include "EntityStore.h"
+#include "FutureEventList.h"
+#include "RandomStream.h"
+#include "ModelParameters.h"
+#include "PlantModel.h"
+#include "Simulation.h"
+#include "SpscQueue.h"
+#include "StationNetwork.h"
+#include "StatisticsPolicies.h"
+
+// One simulation of a PlantModel split over several logical processes, each on its own thread
+// (conservative parallel discrete-event simulation, Chandy-Misra-Bryant).
+//
+// Every logical process simulates a contiguous block of stations, with its own Future Event List,
+// entities and random number streams. The process of the kit station also handles the part arrivals,
+// their inspections and the kitting. An Assembly entity routed to a station of another process is sent
+// to it as a message with the time of the departure, through a single-producer single-consumer channel
+// (see SpscQueue.h), and the event handlers are otherwise those of SimulationEngine (see StationNetwork.h).
+//
+// A process only executes its next event or message when no other process can still send it anything
+// earlier. For this, every process publishes a promise: it will not send a message before the time of
+// its own next event, or before the earliest message it may still receive plus its lookahead, the
+// shortest service time of its stations (an entity that comes in leaves after a service at least). This
+// plays the part of the null messages of the algorithm. A process needs a positive lookahead, so a plant
+// with a service time that can be 0 is not split.
+//
+// Each station and each random number stream is handled by one process in the order of the sequential
+// engine, and the statistics are kept per station, so the results are bit-identical to those of
+// SimulationEngine with SteadyStateStatistics, as long as no two events of different processes happen at
+// exactly the same time (with continuous service and interarrival times, they almost never do). Such ties
+// are broken by the index of the process they come from, lowest first: the results are then still the
+// same from run to run, whatever the timing of the threads, but may differ from those of SimulationEngine,
+// which executes them in the order in which they were scheduled.
+//
+// Every process but the first runs on a thread of its own, so a simulation with n processes keeps n cores
+// busy (ReplicationRunner runs fewer simulations at once, see Simulation::logicalProcesses).
+//
+// The service times of the reference plant (reference_plant.txt, and the plant of buildPlantModel) are normal
+// without a minimum, so it has no lookahead and is never split. A plant is split when every station has a
+// 'min' above 0, as in line_plant.txt.
+
+// Logical process of a station, when the stations are split in contiguous blocks
+inline int processOfStation(int station, int numStations, int numProcesses)
+{
+	return static_cast<int>(static_cast<long long>(station) * numProcesses / numStations);
+}
+
+// Number of logical processes that a simulation of the model is split over, for a requested number: at most
+// one per station, and 1 if the service time of some station can be 0 (its process would have no lookahead)
+inline int logicalProcessesFor(const PlantModel &model, int requested)
+{
+	int numStations = static_cast<int>(model.stations.size());
+	int numProcesses = std::max(1, std::min(requested, numStations));
+
+	for (int s = 0; s < numStations; ++s) {
+		if (!(model.stations[s].service.lowest() > 0))
+			return 1;
+	}
+	return numProcesses;
+}
+
+template <class FEL>
+class ParallelSimulationEngine {
+public:
+	// Constructor. The model must outlive the engine. At most 'numProcesses' logical processes are used.
+	ParallelSimulationEngine(const PlantModel &, const ModelParameters &, int numProcesses);
+
+	// Number of logical processes used (see logicalProcessesFor). If it is 1, run must not be called.
+	int processes() const { return numProcesses; }
+
+	// Run simulation number 'replication' (starting at 0)
+	ReplicationOutput run(int replication);
+
+private:
+	// An Assembly entity sent to a station of another logical process, at the time of its departure
+	struct Message {
+		double time;
+		int station;
+		EntityRecord entity;
+	};
+
+	// The stations of one logical process, with the event handlers of SimulationEngine. An entity that leaves
+	// for a station of another process is sent to it as a message.
+	struct LogicalProcess : StationNetwork<LogicalProcess, FEL, BufferedRandomStreams, SteadyStateStatistics> {
+		typedef StationNetwork<LogicalProcess, FEL, BufferedRandomStreams, SteadyStateStatistics> Network;
+
+		LogicalProcess(ParallelSimulationEngine &owner, int i)
+			: Network(owner.model), promise(0), engine(owner), index(i), lookahead(0), numEvents(0) {}
+
+		// Before C++17, new does not align beyond std::max_align_t, so the process is allocated with room to
+		// align it on a cache line, and the block allocated is kept just before it
+		static void *operator new(std::size_t size)
+		{
+			void *block = ::operator new(size + alignof(LogicalProcess));
+			std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block) + alignof(LogicalProcess);
+			void *aligned = reinterpret_cast<void *>(address & ~static_cast<std::uintptr_t>(alignof(LogicalProcess) - 1));
+			static_cast<void **>(aligned)[-1] = block;
+			return aligned;
+		}
+		static void operator delete(void *aligned) { ::operator delete(static_cast<void **>(aligned)[-1]); }
+
+		// Send an entity on to a station of this process or, as a message, of another one
+		void sendTo(int station, EntityHandle ID);
+
+		// No message is sent by this process before this time. It is read by the other threads, so it starts a
+		// cache line of its own, and the members after it on that line are only read while the processes run.
+		alignas(64) std::atomic<double> promise;
+
+		ParallelSimulationEngine &engine;
+		int index;
+		double lookahead;            // Shortest service time of the stations of the process
+		std::vector<int> inputs;     // Processes that send messages to this one
+		std::vector<double> bounds;  // Scratch space of runProcess: the promise of each empty input channel
+		std::vector<int> streamIDs;  // Random number streams used by the process
+
+		unsigned long long numEvents;
+	};
+
+	typedef SpscQueue<Message> Channel;
+
+	// Reset a logical process before a new simulation run
+	void resetProcess(LogicalProcess &, int replication);
+
+	// Execute the events and messages of a logical process until the end of simulation time
+	void runProcess(int index);
+
+	Channel &channel(int from, int to) { return *channels[from * numProcesses + to]; }
+
+	const PlantModel &model;
+	ModelParameters params;
+
+	int numProcesses;
+	std::vector<int> processOf;   // Logical process of each station
+	std::vector<char> linked;     // Whether process i sends messages to process j, at [i * numProcesses + j]
+
+	std::vector<std::unique_ptr<LogicalProcess> > logicalProcesses;
+	std::vector<std::unique_ptr<Channel> > channels; // Channel from process i to process j at [i * numProcesses + j]
+};
+
+// Constructor. Split the stations in contiguous blocks, and find the lookahead of every block.
+template <class FEL>
+ParallelSimulationEngine<FEL>::ParallelSimulationEngine(const PlantModel &plantModel, const ModelParameters &parameters, int requested)
+	: model(plantModel), params(parameters)
+{
+	int numStations = static_cast<int>(model.stations.size());
+	numProcesses = logicalProcessesFor(model, requested);
+	if (numProcesses == 1)
+		return;
+
+	processOf.resize(numStations);
+	for (int s = 0; s < numStations; ++s)
+		processOf[s] = processOfStation(s, numStations, numProcesses);
+
+	std::vector<double> lookahead(numProcesses, HUGE_VAL);
+	for (int s = 0; s < numStations; ++s)
+		lookahead[processOf[s]] = std::min(lookahead[processOf[s]], model.stations[s].service.lowest());
+
+	// The channels follow the routes between stations of different processes
+	linked.assign(numProcesses * numProcesses, 0);
+	for (int s = 0; s < numStations; ++s) {
+		for (int reworked = 0; reworked < 2; ++reworked) {
+			const std::vector<Route> &routes = model.stations[s].routesFor(reworked != 0);
+			for (std::size_t r = 0; r < routes.size(); ++r) {
+				if (routes[r].destination != ROUTE_EXIT && processOf[routes[r].destination] != processOf[s])
+					linked[processOf[s] * numProcesses + processOf[routes[r].destination]] = 1;
+			}
+		}
+	}
+
+	for (int i = 0; i < numProcesses; ++i) {
+		LogicalProcess *process = new LogicalProcess(*this, i);
+		logicalProcesses.push_back(std::unique_ptr<LogicalProcess>(process));
+		process->lookahead = lookahead[i];
+		for (int j = 0; j < numProcesses; ++j) {
+			if (linked[j * numProcesses + i])
+				process->inputs.push_back(j);
+		}
+		process->bounds.resize(process->inputs.size());
+	}
+
+	// The process of the kit station draws the part arrivals and inspections, every process the service
+	// times and the routing of its stations
+	LogicalProcess &kitting = *logicalProcesses[processOf[model.kitStation]];
+	for (std::size_t p = 0; p < model.parts.size(); ++p) {
+		kitting.streamIDs.push_back(model.parts[p].arrivalStream);
+		kitting.streamIDs.push_back(model.parts[p].inspectionStream);
+	}
+	for (int s = 0; s < numStations; ++s) {
+		LogicalProcess &process = *logicalProcesses[processOf[s]];
+		process.streamIDs.push_back(model.stations[s].serviceStream);
+		if (model.stations[s].routingStream >= 0)
+			process.streamIDs.push_back(model.stations[s].routingStream);
+	}
+}
+
+// Run simulation number 'replication' (starting at 0) on one thread per logical process
+template <class FEL>
+ReplicationOutput ParallelSimulationEngine<FEL>::run(int replication)
+{
+	for (int i = 0; i < numProcesses; ++i)
+		resetProcess(*logicalProcesses[i], replication);
+
+	channels.clear();
+	channels.resize(numProcesses * numProcesses);
+	for (int k = 0; k < numProcesses * numProcesses; ++k) {
+		if (linked[k])
+			channels[k].reset(new Channel);
+	}
+
+	// Schedule the first arrival of every part type. The end of simulation is not an event here: every
+	// process stops before the end of simulation time.
+	LogicalProcess &kitting = *logicalProcesses[processOf[model.kitStation]];
+	for (std::size_t p = 0; p < model.parts.size(); ++p)
+		kitting.scheduleArrival(static_cast<std::uint32_t>(p));
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < numProcesses; ++i)
+		threads.push_back(std::thread(&ParallelSimulationEngine::runProcess, this, i));
+	runProcess(0);
+	for (std::size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+
+	// Gather the statistics of every station from its process. The end of simulation counts as an event,
+	// as in SimulationEngine.
+	SteadyStateStatistics stats;
+	stats.reset(params, model);
+	stats.takeCreated(kitting.stats);
+	for (std::size_t s = 0; s < model.stations.size(); ++s)
+		stats.takeStation(logicalProcesses[processOf[s]]->stats, static_cast<int>(s));
+
+	ReplicationOutput output;
+	output.result.simulationNumber = replication + 1;
+	output.numEvents = 1;
+	for (int i = 0; i < numProcesses; ++i)
+		output.numEvents += logicalProcesses[i]->numEvents;
+	stats.fillResult(output.result);
+
+	return output;
+}
+
+// Reset a logical process before a new simulation run
+template <class FEL>
+void ParallelSimulationEngine<FEL>::resetProcess(LogicalProcess &process, int replication)
+{
+	process.promise.store(0);
+	process.numEvents = 0;
+	process.resetNetwork(params);
+	if (Instrumentation::enabled)
+		process.instrumentation.begin(model.stations.size());
+
+	for (std::size_t k = 0; k < process.streamIDs.size(); ++k) {
+		int id = process.streamIDs[k];
+		process.randomStreams[id].reseed(params.masterSeed, static_cast<std::uint32_t>(id), params.streamReplication(replication),
+			params.antitheticReplication(replication));
+	}
+}
+
+// Execute the events and messages of a logical process in time order
+template <class FEL>
+void ParallelSimulationEngine<FEL>::runProcess(int index)
+{
+	LogicalProcess &process = *logicalProcesses[index];
+	const double endTime = params.endSimulationTime;
+
+	// The next event of the process, taken out of the FEL
+	Event nextEvent = Event();
+	bool hasEvent = false;
+
+	while (1) {
+
+		if (!hasEvent && !process.listOfEvents.empty()) {
+			nextEvent = process.listOfEvents.popNext();
+			hasEvent = true;
+		}
+		double eventTime = hasEvent ? nextEvent.getTimeOfEvent() : HUGE_VAL;
+
+		// Find the first of the next event and the first message of every input, in order of time and then of
+		// the process they come from. Messages on a channel come in time order, and an empty channel receives
+		// nothing before the promise of its sender, which is read before the channel.
+		double time = eventTime;
+		int origin = index;              // Process of the event or message that comes first
+		int source = -1;                 // Its input, or -1 for the next event
+		double earliestInput = HUGE_VAL; // Nothing can be received before this time
+		for (std::size_t k = 0; k < process.inputs.size(); ++k) {
+			int from = process.inputs[k];
+			double promised = logicalProcesses[from]->promise.load(std::memory_order_acquire);
+			const Message *message = channel(from, index).front();
+			if (message) {
+				process.bounds[k] = HUGE_VAL;
+				earliestInput = std::min(earliestInput, message->time);
+				if (message->time < time || (message->time == time && from < origin)) {
+					time = message->time;
+					origin = from;
+					source = from;
+				}
+			}
+			else {
+				process.bounds[k] = promised;
+				earliestInput = std::min(earliestInput, promised);
+			}
+		}
+
+		// Anything sent from now on is at the time of the next event at least, or leaves after a service
+		process.promise.store(std::min(eventTime, earliestInput + process.lookahead), std::memory_order_release);
+
+		// Stop once nothing is left before the end of simulation time
+		if (time >= endTime) {
+			if (earliestInput >= endTime)
+				break;
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Wait until no message can come before, or at the same time from a process with a lower index
+		bool wait = false;
+		for (std::size_t k = 0; k < process.inputs.size() && !wait; ++k)
+			wait = process.bounds[k] < time || (process.bounds[k] == time && process.inputs[k] < origin);
+		if (wait) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		process.simulationTime = time;
+		if (source < 0) {
+			hasEvent = false;
+			process.numEvents++;
+			if (nextEvent.getEventType() == EVENT_ARRIVAL)
+				process.arrival(nextEvent);
+			else
+				process.departure(nextEvent);
+		}
+		else {
+			if (hasEvent) {
+				process.listOfEvents.putBack(nextEvent);
+				hasEvent = false;
+			}
+
+			Channel &input = channel(source, index);
+			const Message *message = input.front();
+			int station = message->station;
+			EntityHandle ID = process.entities.adopt(message->entity);
+			input.pop();
+			process.arriveAtStation(station, ID);
+		}
+	}
+
+	process.promise.store(HUGE_VAL, std::memory_order_release);
+}
+
+// Send an entity that leaves a station on to the next station of its route. An entity for another process is
+// copied into a message at the time of the departure, and released here.
+template <class FEL>
+void ParallelSimulationEngine<FEL>::LogicalProcess::sendTo(int station, EntityHandle ID)
+{
+	int to = engine.processOf[station];
+	if (to == index) {
+		this->arriveAtStation(station, ID);
+		return;
+	}
+
+	Message message;
+	message.time = this->simulationTime;
+	message.station = station;
+	message.entity = this->entities[ID];
+	engine.channel(index, to).push(message);
+	this->entities.release(ID);
+}
+
+#endif /* PARALLEL_ENGINE_H */
@@ -0,0 +1,554 @@
+// Definition of the plant model description.
+
+#include <fstream>
+#include <sstream>
+#include <cmath> // std::fabs
+
+// Include header file for the plant model description
+#include "PlantModel.h"
+
+// Index of a station by name, -1 if there is none
+int PlantModel::findStation(const std::string &name) const
+{
+	for (std::size_t s = 0; s < stations.size(); ++s) {
+		if (stations[s].name == name)
+			return static_cast<int>(s);
+	}
+
+	return -1;
+}
+
+// Total number of servers of all stations
+int PlantModel::numServers() const
+{
+	int total = 0;
+	for (std::size_t s = 0; s < stations.size(); ++s)
+		total += stations[s].servers;
+
+	return total;
+}
+
+// Whether some part type has an arrival trace
+bool PlantModel::hasArrivalTraces() const
+{
+	for (std::size_t p = 0; p < parts.size(); ++p) {
+		if (parts[p].arrivalTrace)
+			return true;
+	}
+
+	return false;
+}
+
+// Whether some station has breakdowns or a shift calendar
+bool PlantModel::hasDowntime() const
+{
+	for (std::size_t s = 0; s < stations.size(); ++s) {
+		if (stations[s].failures || stations[s].shiftOff > 0)
+			return true;
+	}
+
+	return false;
+}
+
+// Number the random number streams
+void PlantModel::assignStreams()
+{
+	int numParts = static_cast<int>(parts.size());
+	int numStations = static_cast<int>(stations.size());
+
+	for (int p = 0; p < numParts; ++p) {
+		parts[p].arrivalStream = p;
+		parts[p].inspectionStream = numParts + p;
+	}
+
+	numStreams = 2 * numParts + numStations;
+	for (int s = 0; s < numStations; ++s) {
+		Station &station = stations[s];
+		station.serviceStream = 2 * numParts + s;
+
+		// Only stations with a choice to make draw a random number for the routing
+		if (station.routes.size() > 1 || station.reworkedRoutes.size() > 1)
+			station.routingStream = numStreams++;
+		else
+			station.routingStream = -1;
+	}
+
+	for (int s = 0; s < numStations; ++s) {
+		Station &station = stations[s];
+		station.failureStream = station.failures ? numStreams++ : -1;
+		station.repairStream = station.failures ? numStreams++ : -1;
+	}
+}
+
+// Check the probabilities and destinations of a table of routes
+static bool validateRoutes(const PlantModel &model, const Station &station, const std::vector<Route> &routes, std::string &error)
+{
+	double total = 0;
+	for (std::size_t r = 0; r < routes.size(); ++r) {
+		int destination = routes[r].destination;
+		if (destination != ROUTE_EXIT && (destination < 0 || destination >= static_cast<int>(model.stations.size()))) {
+			error = "station '" + station.name + "' has a route to a station that does not exist";
+			return false;
+		}
+		if (routes[r].probability < 0 || routes[r].probability > 1) {
+			error = "station '" + station.name + "' has a route probability outside [0, 1]";
+			return false;
+		}
+		total += routes[r].probability;
+	}
+
+	if (!routes.empty() && std::fabs(total - 1) > 1e-9) {
+		error = "the route probabilities of station '" + station.name + "' do not add up to 1";
+		return false;
+	}
+
+	return true;
+}
+
+// Check that the model can be simulated
+bool PlantModel::validate(std::string &error) const
+{
+	if (parts.empty() || stations.empty()) {
+		error = "a plant needs at least one part type and one station";
+		return false;
+	}
+	if (stations.size() > 65535) {
+		error = "a plant has at most 65535 stations";
+		return false;
+	}
+	if (kitStation < 0 || kitStation >= static_cast<int>(stations.size())) {
+		error = "the kitting step does not lead to a station";
+		return false;
+	}
+
+	for (std::size_t p = 0; p < parts.size(); ++p) {
+		const PartType &part = parts[p];
+		if (part.acceptProbability < 0 || part.acceptProbability > 1) {
+			error = "part '" + part.name + "' has an acceptance probability outside [0, 1]";
+			return false;
+		}
+		if (part.kitQuantity < 1) {
+			error = "part '" + part.name + "' needs a kit quantity of at least 1";
+			return false;
+		}
+		if (!part.arrivalTrace && part.interArrival.mean <= 0) {
+			error = "part '" + part.name + "' needs a positive mean interarrival time";
+			return false;
+		}
+	}
+
+	for (std::size_t s = 0; s < stations.size(); ++s) {
+		const Station &station = stations[s];
+		if (station.servers < 1 || station.servers > 65535) {
+			error = "station '" + station.name + "' needs between 1 and 65535 servers";
+			return false;
+		}
+		if (station.service.mean < 0 || station.service.stdev < 0) {
+			error = "station '" + station.name + "' needs a service time with a mean and standard deviation of at least 0";
+			return false;
+		}
+		if (!validateRoutes(*this, station, station.routes, error) || !validateRoutes(*this, station, station.reworkedRoutes, error))
+			return false;
+		if (station.failures && (station.timeToFailure.mean <= 0 || station.repairTime.mean <= 0)) {
+			error = "station '" + station.name + "' needs positive mean times to failure and repair times";
+			return false;
+		}
+		if (station.shiftOff > 0 && station.shiftOn <= 0) {
+			error = "station '" + station.name + "' needs shifts of positive length";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////
+//               Reference plant                //
+//////////////////////////////////////////////////
+
+// Add a part type to a model
+static void addPart(PlantModel &model, const char *name, double interArrivalMean, double acceptProbability)
+{
+	PartType part;
+	part.name = name;
+	part.interArrival = Distribution(DIST_EXPONENTIAL, interArrivalMean);
+	part.acceptProbability = acceptProbability;
+	model.parts.push_back(part);
+}
+
+// Add a station to a model and return its index
+static int addStation(PlantModel &model, const char *name, double serviceMean, double serviceStdev, int servers)
+{
+	Station station;
+	station.name = name;
+	station.service = Distribution(DIST_NORMAL, serviceMean, serviceStdev);
+	station.servers = servers;
+	model.stations.push_back(station);
+
+	return static_cast<int>(model.stations.size()) - 1;
+}
+
+// The plant of this project
+PlantModel referencePlant(const ModelParameters &params)
+{
+	PlantModel model;
+
+	// The 5 parts, in the order of StreamID
+	addPart(model, "Rod End", params.interArr_RodEnd, params.accProb_RodEnd);
+	addPart(model, "Piston", params.interArr_Piston, params.accProb_Piston);
+	addPart(model, "Cylinder Cap", params.interArr_CylinderCap, params.accProb_CylinderCap);
+	addPart(model, "Cylinder", params.interArr_Cylinder, params.accProb_Cylinder);
+	addPart(model, "Cylinder Rod End", params.interArr_CylinderRodEnd, params.accProb_CylinderRodEnd);
+
+	int assembly = addStation(model, "Assembly", params.srvcTime_Assembly_Mean, params.srvcTime_Assembly_Stdev, params.numServers_Assembly);
+	int coating = addStation(model, "Coating", params.srvcTime_Coating_Mean, params.srvcTime_Coating_Stdev, params.numServers_Coating);
+	int reWork = addStation(model, "ReWork", params.srvcTime_Rework_Mean, params.srvcTime_Rework_Stdev, params.numServers_Rework);
+
+	// Assembly -> Coating -> assembly-level inspection: accepted assemblies leave the plant, rejected ones
+	// go to ReWork and then back to Assembly. Reworked assemblies are accepted with a different probability.
+	model.stations[assembly].routes.push_back(Route(coating, 1));
+
+	double accepted = params.accProb_Assembly_NoRework;
+	double acceptedReworked = (params.accProb_Assembly_Rework < 1) ? params.accProb_Assembly_Rework : 1;
+	model.stations[coating].routes.push_back(Route(ROUTE_EXIT, accepted));
+	model.stations[coating].routes.push_back(Route(reWork, 1 - accepted));
+	model.stations[coating].reworkedRoutes.push_back(Route(ROUTE_EXIT, acceptedReworked));
+	model.stations[coating].reworkedRoutes.push_back(Route(reWork, 1 - acceptedReworked));
+
+	model.stations[reWork].rework = true;
+	model.stations[reWork].routes.push_back(Route(assembly, 1));
+
+	model.kitStation = assembly;
+	model.assemblyStation = assembly;
+	model.reworkStation = reWork;
+	model.assignStreams();
+
+	return model;
+}
+
+// The model simulated with these parameters
+PlantModel buildPlantModel(const ModelParameters &params)
+{
+	if (params.plantModel)
+		return *params.plantModel;
+
+	return referencePlant(params);
+}
+
+//////////////////////////////////////////////////
+//              Model description               //
+//////////////////////////////////////////////////
+
+// Read the next word of a line. A name with spaces is written in double quotes.
+static bool readWord(std::istream &in, std::string &word)
+{
+	in >> std::ws;
+	if (in.peek() != '"')
+		return static_cast<bool>(in >> word);
+
+	in.get();
+	return static_cast<bool>(std::getline(in, word, '"'));
+}
+
+// Read a distribution: "exponential <mean>", "normal <mean> <stdev>" or "constant <value>", optionally
+// followed by "min <value>" (0 by default)
+static bool readDistribution(std::istream &in, Distribution &distribution, std::string &error)
+{
+	std::string type;
+	in >> type;
+	if (type == "exponential") {
+		distribution.type = DIST_EXPONENTIAL;
+		in >> distribution.mean;
+	}
+	else if (type == "normal") {
+		distribution.type = DIST_NORMAL;
+		in >> distribution.mean >> distribution.stdev;
+	}
+	else if (type == "constant") {
+		distribution.type = DIST_CONSTANT;
+		in >> distribution.mean;
+	}
+	else {
+		error = "unknown distribution '" + type + "' (use exponential, normal or constant)";
+		return false;
+	}
+
+	if (!in) {
+		error = "expected the parameters of the " + type + " distribution";
+		return false;
+	}
+
+	std::streampos options = in.tellg();
+	std::string word;
+	if ((in >> word) && word == "min") {
+		if (!(in >> distribution.minimum)) {
+			error = "expected a value after 'min'";
+			return false;
+		}
+	}
+	else {
+		in.clear();
+		in.seekg(options);
+	}
+
+	return true;
+}
+
+// Path of a file named in a model file: relative paths are relative to the directory of the model file
+static std::string relativeTo(const std::string &modelPath, const std::string &path)
+{
+	bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+	std::string::size_type slash = modelPath.find_last_of("/\\");
+	if (absolute || slash == std::string::npos)
+		return path;
+
+	return modelPath.substr(0, slash + 1) + path;
+}
+
+// A route line, resolved once all stations are known
+struct RouteLine {
+	std::string where;
+	std::string station;
+	bool reworked;
+	std::vector<std::pair<std::string, double> > destinations;
+};
+
+// Read a plant model from a text file
+bool loadPlantModel(const std::string &path, PlantModel &model, std::string &error)
+{
+	std::ifstream file(path.c_str());
+	if (!file) {
+		error = "cannot open " + path;
+		return false;
+	}
+
+	model = PlantModel();
+	std::vector<RouteLine> routeLines;
+	std::string kitStation;
+	std::string assemblyStation;
+	std::string reworkStation;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+
+		// Remove comments
+		std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream words(line);
+		std::string keyword;
+		if (!(words >> keyword))
+			continue; // Blank line
+
+		std::ostringstream where;
+		where << path << ", line " << lineNumber << ": ";
+
+		if (keyword == "part") {
+			PartType part;
+			if (!readWord(words, part.name)) {
+				error = where.str() + "expected the name of the part";
+				return false;
+			}
+
+			// The interarrival distribution, or the file of recorded arrivals
+			std::streampos distribution = words.tellg();
+			std::string type;
+			if ((words >> type) && type == "trace") {
+				std::string tracePath;
+				if (!readWord(words, tracePath)) {
+					error = where.str() + "expected the file of the arrival trace";
+					return false;
+				}
+				std::shared_ptr<ArrivalTrace> trace = std::make_shared<ArrivalTrace>();
+				if (!trace->open(relativeTo(path, tracePath), error)) {
+					error = where.str() + error;
+					return false;
+				}
+				part.arrivalTrace = trace;
+			}
+			else {
+				words.clear();
+				words.seekg(distribution);
+				if (!readDistribution(words, part.interArrival, error)) {
+					error = where.str() + error;
+					return false;
+				}
+			}
+
+			std::string option;
+			while (words >> option) {
+				bool hasValue;
+				if (option == "accept")
+					hasValue = static_cast<bool>(words >> part.acceptProbability);
+				else if (option == "kit")
+					hasValue = static_cast<bool>(words >> part.kitQuantity);
+				else {
+					error = where.str() + "unknown option '" + option + "' (use accept or kit)";
+					return false;
+				}
+
+				if (!hasValue) {
+					error = where.str() + "expected a number after '" + option + "'";
+					return false;
+				}
+			}
+			model.parts.push_back(part);
+		}
+		else if (keyword == "station") {
+			Station station;
+			if (!readWord(words, station.name)) {
+				error = where.str() + "expected the name of the station";
+				return false;
+			}
+			if (model.findStation(station.name) >= 0) {
+				error = where.str() + "station '" + station.name + "' is defined twice";
+				return false;
+			}
+			if (!readDistribution(words, station.service, error)) {
+				error = where.str() + error;
+				return false;
+			}
+
+			std::string option;
+			while (words >> option) {
+				if (option == "rework")
+					station.rework = true;
+				else if (option == "servers") {
+					if (!(words >> station.servers)) {
+						error = where.str() + "expected a number after 'servers'";
+						return false;
+					}
+				}
+				else {
+					error = where.str() + "unknown option '" + option + "' (use servers or rework)";
+					return false;
+				}
+			}
+			model.stations.push_back(station);
+		}
+		else if (keyword == "route") {
+			RouteLine routeLine;
+			routeLine.where = where.str();
+			routeLine.reworked = false;
+			if (!readWord(words, routeLine.station)) {
+				error = where.str() + "expected the name of the station";
+				return false;
+			}
+
+			std::string destination;
+			while (readWord(words, destination)) {
+				if (destination == "reworked" && routeLine.destinations.empty() && !routeLine.reworked) {
+					routeLine.reworked = true;
+					continue;
+				}
+
+				double probability;
+				if (!(words >> probability)) {
+					error = where.str() + "expected a probability after '" + destination + "'";
+					return false;
+				}
+				routeLine.destinations.push_back(std::make_pair(destination, probability));
+			}
+			if (routeLine.destinations.empty()) {
+				error = where.str() + "expected at least one destination";
+				return false;
+			}
+			routeLines.push_back(routeLine);
+		}
+		else if (keyword == "breakdown" || keyword == "shift") {
+			std::string name;
+			if (!readWord(words, name)) {
+				error = where.str() + "expected the name of the station";
+				return false;
+			}
+			int s = model.findStation(name);
+			if (s < 0) {
+				error = where.str() + "unknown station '" + name + "' (define it before its " + keyword + ")";
+				return false;
+			}
+
+			Station &station = model.stations[s];
+			if (keyword == "breakdown") {
+				if (!readDistribution(words, station.timeToFailure, error)) {
+					error = where.str() + error;
+					return false;
+				}
+				std::string repair;
+				if (!(words >> repair) || repair != "repair") {
+					error = where.str() + "expected 'repair' and the distribution of the repair times";
+					return false;
+				}
+				if (!readDistribution(words, station.repairTime, error)) {
+					error = where.str() + error;
+					return false;
+				}
+				station.failures = true;
+			}
+			else if (!(words >> station.shiftOn >> station.shiftOff)) {
+				error = where.str() + "expected 'shift <station> <minutes on> <minutes off>'";
+				return false;
+			}
+		}
+		else if (keyword == "kit") {
+			if (!readWord(words, kitStation)) {
+				error = where.str() + "expected the name of the station";
+				return false;
+			}
+		}
+		else if (keyword == "report") {
+			std::string statistic;
+			std::string name;
+			words >> statistic;
+			if (!readWord(words, name) || (statistic != "assembly" && statistic != "rework")) {
+				error = where.str() + "expected 'report assembly <station>' or 'report rework <station>'";
+				return false;
+			}
+			(statistic == "assembly" ? assemblyStation : reworkStation) = name;
+		}
+		else {
+			error = where.str() + "unknown keyword '" + keyword + "'";
+			return false;
+		}
+	}
+
+	// Resolve the station names
+	for (std::size_t r = 0; r < routeLines.size(); ++r) {
+		const RouteLine &routeLine = routeLines[r];
+		int from = model.findStation(routeLine.station);
+		if (from < 0) {
+			error = routeLine.where + "unknown station '" + routeLine.station + "'";
+			return false;
+		}
+
+		std::vector<Route> &routes = routeLine.reworked ? model.stations[from].reworkedRoutes : model.stations[from].routes;
+		routes.clear();
+		for (std::size_t d = 0; d < routeLine.destinations.size(); ++d) {
+			const std::string &name = routeLine.destinations[d].first;
+			int destination = (name == "exit") ? ROUTE_EXIT : model.findStation(name);
+			if (name != "exit" && destination < 0) {
+				error = routeLine.where + "unknown station '" + name + "'";
+				return false;
+			}
+			routes.push_back(Route(destination, routeLine.destinations[d].second));
+		}
+	}
+
+	model.kitStation = kitStation.empty() ? 0 : model.findStation(kitStation);
+	model.assemblyStation = assemblyStation.empty() ? -1 : model.findStation(assemblyStation);
+	model.reworkStation = reworkStation.empty() ? -1 : model.findStation(reworkStation);
+	if ((!assemblyStation.empty() && model.assemblyStation < 0) || (!reworkStation.empty() && model.reworkStation < 0)) {
+		error = path + ": a 'report' line names an unknown station";
+		return false;
+	}
+
+	model.assignStreams();
+	if (!model.validate(error)) {
+		error = path + ": " + error;
+		return false;
+	}
+
+	return true;
+}
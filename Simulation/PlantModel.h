@@ -0,0 +1,186 @@
+// Header file for the plant model description
+#ifndef PLANT_MODEL_H
+#define PLANT_MODEL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "ModelParameters.h"
+#include "RandomStream.h"
+#include "ArrivalTrace.h"
+
+// Families of probability distributions of interarrival and service times
+enum DistributionType {
+	DIST_CONSTANT,    // Always 'mean'
+	DIST_EXPONENTIAL, // Exponential with mean 'mean'
+	DIST_NORMAL       // Normal with mean 'mean' and standard deviation 'stdev'
+};
+
+// A distribution of interarrival or service times. Samples below 'minimum' are raised to 'minimum',
+// so that a normal service time never moves the simulation clock backwards.
+struct Distribution {
+	Distribution() : type(DIST_CONSTANT), mean(0), stdev(0), minimum(0) {}
+	Distribution(DistributionType t, double m, double s = 0, double min = 0) : type(t), mean(m), stdev(s), minimum(min) {}
+
+	// Draw a sample from a random number stream (a RandomStream or a BufferedRandomStream)
+	template <class Stream>
+	double sample(Stream &stream) const
+	{
+		double x;
+		switch (type) {
+		case DIST_EXPONENTIAL:
+			x = stream.exponential(mean);
+			break;
+		case DIST_NORMAL:
+			x = stream.normal(mean, stdev);
+			break;
+		default:
+			x = mean;
+			break;
+		}
+
+		return (x < minimum) ? minimum : x;
+	}
+
+	// Lowest value that sample can return
+	double lowest() const
+	{
+		return (type == DIST_CONSTANT && mean > minimum) ? mean : minimum;
+	}
+
+	DistributionType type;
+	double mean;
+	double stdev;
+	double minimum;
+};
+
+// Destination of a route that leaves the plant (the Assembly entity is delivered)
+static const int ROUTE_EXIT = -1;
+
+// A possible next step of an Assembly entity after a station: go to station 'destination' (or leave
+// the plant with ROUTE_EXIT) with probability 'probability'
+struct Route {
+	Route(int d, double p) : destination(d), probability(p) {}
+
+	int destination;
+	double probability;
+};
+
+// A type of part received by the plant. Parts arrive one at a time and are inspected on arrival;
+// accepted parts wait until there is a complete kit (kitQuantity parts of every type), which is
+// joined into a new Assembly entity. With an arrival trace, the recorded arrivals are replayed instead
+// of drawing interarrival times (see ArrivalTrace.h); the part type keeps its arrival stream, unused, so
+// that the other streams are numbered as without the trace.
+struct PartType {
+	PartType() : acceptProbability(1), kitQuantity(1), arrivalStream(-1), inspectionStream(-1) {}
+
+	std::string name;
+	Distribution interArrival;
+	double acceptProbability; // Probability that a part passes its receiving inspection
+	int kitQuantity;          // Number of parts of this type in an Assembly
+	std::shared_ptr<const ArrivalTrace> arrivalTrace; // Recorded arrivals, or null to draw interarrival times
+
+	// Random number streams of the interarrival times and of the inspection (set by assignStreams)
+	int arrivalStream;
+	int inspectionStream;
+};
+
+// A station: 'servers' identical servers in parallel with a single First In First Out queue. After
+// service, an Assembly entity follows one of the station's routes, picked at random with the route
+// probabilities.
+//
+// A station may be down for a while: when it breaks down until it is repaired, and between its shifts.
+// While it is down, arriving entities wait in the queue, and the services under way are interrupted and
+// resume where they stopped once it is up again (preempt-resume).
+struct Station {
+	Station() : servers(1), rework(false), failures(false), shiftOn(0), shiftOff(0), serviceStream(-1), routingStream(-1),
+		failureStream(-1), repairStream(-1) {}
+
+	// Routes followed by an entity, depending on whether it has been reworked
+	const std::vector<Route> &routesFor(bool reworked) const
+	{
+		return (reworked && !reworkedRoutes.empty()) ? reworkedRoutes : routes;
+	}
+
+	std::string name;
+	Distribution service;
+	int servers;                       // Number of servers (parallel capacity)
+	bool rework;                       // Entities leaving this station count as reworked
+
+	std::vector<Route> routes;         // Empty means that entities leave the plant after service
+	std::vector<Route> reworkedRoutes; // Used instead of 'routes' for reworked entities, if not empty
+
+	// Breakdowns: with 'failures', the station breaks down after a time drawn from 'timeToFailure', counted
+	// from the end of its last repair (or from the start), and is repaired after a time drawn from 'repairTime'
+	bool failures;
+	Distribution timeToFailure;
+	Distribution repairTime;
+
+	// Shift calendar: with 'shiftOff' > 0, the station works for 'shiftOn' minutes, then is closed for
+	// 'shiftOff' minutes, and so on from the start of the simulation
+	double shiftOn;
+	double shiftOff;
+
+	// Random number streams of the service times and of the routing (set by assignStreams). The routing
+	// stream is -1 if there is no choice to make (at most one route for every entity), and the failure and
+	// repair streams are -1 without breakdowns.
+	int serviceStream;
+	int routingStream;
+	int failureStream;
+	int repairStream;
+};
+
+// A plant: the part types, the kitting step that joins a kit of parts into an Assembly entity, and the
+// network of stations that Assembly entities go through. SimulationEngine runs any PlantModel with the
+// same event handlers; the reference plant of this project is built by referencePlant.
+struct PlantModel {
+	PlantModel() : kitStation(0), assemblyStation(-1), reworkStation(-1), numStreams(0) {}
+
+	// Index of a station by name, -1 if there is none
+	int findStation(const std::string &name) const;
+
+	// Total number of servers of all stations
+	int numServers() const;
+
+	// Whether the arrivals of some part type are replayed from a trace
+	bool hasArrivalTraces() const;
+
+	// Whether some station has breakdowns or a shift calendar
+	bool hasDowntime() const;
+
+	// Number the random number streams: the interarrival times of every part type, then their inspections,
+	// then the service times of every station, then the routing of every station that has a choice to make,
+	// then the times to failure and repair times of every station that has breakdowns. For the reference
+	// plant, this is the order of StreamID.
+	void assignStreams();
+
+	// Check that the model can be simulated. Returns false with a message if it cannot.
+	bool validate(std::string &error) const;
+
+	std::vector<PartType> parts;
+	std::vector<Station> stations;
+
+	// Station where new Assembly entities go
+	int kitStation;
+
+	// Stations reported in the "Prop. Assembly St. Busy" and "Prop. Rework Busy" statistics (-1 for none)
+	int assemblyStation;
+	int reworkStation;
+
+	// Number of random number streams used by the model (set by assignStreams)
+	int numStreams;
+};
+
+// The plant of this project, with the inputs in ModelParameters: 5 part types kitted into an Assembly,
+// then the Assembly, Coating and ReWork stations, with the assembly-level inspection after Coating.
+PlantModel referencePlant(const ModelParameters &);
+
+// The model simulated with these parameters: params.plantModel if set, the reference plant otherwise
+PlantModel buildPlantModel(const ModelParameters &);
+
+// Read a plant model from a text file. Returns false with a message if the file cannot be read or the
+// model is not valid. See reference_plant.txt for the format.
+bool loadPlantModel(const std::string &path, PlantModel &, std::string &error);
+
+#endif /* PLANT_MODEL_H */
@@ -0,0 +1,123 @@
+// Definition of class QuantileSketch.
+
+#include <cmath>
+
+// Include header file for class QuantileSketch
+#include "QuantileSketch.h"
+
+// Below 2^52 units, every number of units converts to a double exactly, so indexOf finds its power of 2
+const double QuantileSketch::maxUnits = 4503599627370496.0;
+
+// Constructor
+QuantileSketch::QuantileSketch(double unit) : resolution(unit), scale(1 / unit)
+{
+	clear();
+}
+
+// Remove all observations
+void QuantileSketch::clear()
+{
+	buckets.clear();
+	count = 0;
+	total = 0;
+	minimum = 0;
+	maximum = 0;
+}
+
+// Add the observations of another sketch. An empty sketch takes the resolution of the other; otherwise the
+// buckets only add up if they have the same width.
+bool QuantileSketch::merge(const QuantileSketch &other)
+{
+	if (other.count == 0)
+		return true;
+	if (count == 0) {
+		*this = other;
+		return true;
+	}
+	if (other.resolution != resolution)
+		return false;
+
+	if (other.buckets.size() > buckets.size())
+		buckets.resize(other.buckets.size(), 0);
+	for (std::size_t b = 0; b < other.buckets.size(); ++b)
+		buckets[b] += other.buckets[b];
+
+	if (other.minimum < minimum)
+		minimum = other.minimum;
+	if (other.maximum > maximum)
+		maximum = other.maximum;
+	count += other.count;
+	total += other.total;
+	return true;
+}
+
+// Value in the middle of a bucket. The buckets below 2 * subBuckets are one unit wide and stand for
+// their lower bound, so that counts are exact.
+double QuantileSketch::middleOf(std::size_t index) const
+{
+	if (index < 2 * static_cast<std::size_t>(subBuckets))
+		return index * resolution;
+
+	int shift = static_cast<int>(index / subBuckets) - 1;
+	double lower = std::ldexp(static_cast<double>(index - static_cast<std::size_t>(shift) * subBuckets), shift);
+	double width = std::ldexp(1.0, shift);
+	return (lower + width / 2) * resolution;
+}
+
+// Estimate of a quantile: the middle of the bucket of the observation of rank ceil(q * count), kept
+// within the smallest and largest observations
+double QuantileSketch::quantile(double q) const
+{
+	if (count == 0)
+		return 0;
+
+	double rank = std::ceil(q * static_cast<double>(count));
+	if (rank < 1)
+		rank = 1;
+
+	double cumulative = 0;
+	std::size_t index = 0;
+	for (; index < buckets.size(); ++index) {
+		cumulative += static_cast<double>(buckets[index]);
+		if (cumulative >= rank)
+			break;
+	}
+	if (index == buckets.size())
+		return maximum;
+
+	double value = middleOf(index);
+	if (value < minimum)
+		return minimum;
+	if (value > maximum)
+		return maximum;
+	return value;
+}
+
+// Append the state: the resolution, the totals and the buckets (counts are exact as doubles up to 2^53)
+void QuantileSketch::save(std::vector<double> &out) const
+{
+	out.push_back(resolution);
+	out.push_back(static_cast<double>(count));
+	out.push_back(total);
+	out.push_back(minimum);
+	out.push_back(maximum);
+	out.push_back(static_cast<double>(buckets.size()));
+	for (std::size_t b = 0; b < buckets.size(); ++b)
+		out.push_back(static_cast<double>(buckets[b]));
+}
+
+// Restore a saved state
+std::size_t QuantileSketch::restore(const std::vector<double> &in, std::size_t i)
+{
+	resolution = in[i];
+	scale = 1 / resolution;
+	count = static_cast<std::uint64_t>(in[i + 1]);
+	total = in[i + 2];
+	minimum = in[i + 3];
+	maximum = in[i + 4];
+	buckets.resize(static_cast<std::size_t>(in[i + 5]));
+	i += 6;
+	for (std::size_t b = 0; b < buckets.size(); ++b)
+		buckets[b] = static_cast<std::uint64_t>(in[i++]);
+	return i;
+}
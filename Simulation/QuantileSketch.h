@@ -0,0 +1,105 @@
+// Header file for class QuantileSketch
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <cmath>   // std::frexp
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streaming estimate of the distribution of a nonnegative quantity (e.g. the time in system of every
+// assembly), to report its quantiles without keeping the observations.
+//
+// It is a log-linear histogram, in the manner of HdrHistogram. Observations are counted in units of
+// 'resolution'. Below 2 * subBuckets units every unit has its own bucket; above, every power of 2 is split
+// into subBuckets buckets of equal width. A quantile is the middle of its bucket, so it is within half a
+// unit, or within 1 / (2 * subBuckets) (1.6%) of the true value. Integers counted with a resolution of 1
+// (e.g. rework loops) are exact up to 2 * subBuckets.
+//
+// The buckets grow with the logarithm of the largest observation (a few KB for times of up to days), and
+// two sketches with the same resolution are merged exactly by adding their buckets: the sketches of
+// replications run on different threads add up to that of all of them.
+class QuantileSketch {
+public:
+	static const int subBucketBits = 5;
+	static const int subBuckets = 1 << subBucketBits;
+
+	explicit QuantileSketch(double resolution = 0.001);
+
+	void clear();
+
+	// Record an observation. Negative values count as 0.
+	void add(double value)
+	{
+		double units = value * scale;
+		std::uint64_t x = 0;
+		if (units >= maxUnits)
+			x = static_cast<std::uint64_t>(maxUnits);
+		else if (units > 0)
+			x = static_cast<std::uint64_t>(units);
+
+		std::size_t index = indexOf(x);
+		if (index >= buckets.size())
+			buckets.resize(index + 1, 0);
+		buckets[index]++;
+
+		if (count == 0 || value < minimum)
+			minimum = value;
+		if (count == 0 || value > maximum)
+			maximum = value;
+		count++;
+		total += value;
+	}
+
+	// Add the observations of another sketch, with the same resolution (an empty sketch takes that of the other).
+	// Returns false, and adds nothing, if the resolutions differ (e.g. a sketch restored from a file written
+	// by another version).
+	bool merge(const QuantileSketch &);
+
+	std::uint64_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	// Exact mean, smallest and largest observation (0 if there is none)
+	double mean() const { return count == 0 ? 0 : total / count; }
+	double min() const { return minimum; }
+	double max() const { return maximum; }
+
+	// Estimate of the quantile q (0 < q <= 1) of the observations, e.g. 0.99 for the 99th percentile.
+	// 0 if there is none.
+	double quantile(double q) const;
+
+	// Append the state to 'out', and restore it from in[i], in[i + 1], ... (returns the next index)
+	void save(std::vector<double> &out) const;
+	std::size_t restore(const std::vector<double> &in, std::size_t i);
+
+private:
+	// Largest number of units counted: larger observations go to the last bucket
+	static const double maxUnits;
+
+	// Bucket of a number of units
+	static std::size_t indexOf(std::uint64_t x)
+	{
+		if (x < 2 * static_cast<std::uint64_t>(subBuckets))
+			return static_cast<std::size_t>(x);
+
+		// x is in [2^(e - 1), 2^e): keep its top subBucketBits + 1 bits
+		int e;
+		std::frexp(static_cast<double>(x), &e);
+		int shift = e - 1 - subBucketBits;
+		return static_cast<std::size_t>(x >> shift) + static_cast<std::size_t>(shift) * subBuckets;
+	}
+
+	// Value in the middle of a bucket
+	double middleOf(std::size_t index) const;
+
+	double resolution;
+	double scale; // 1 / resolution
+
+	std::vector<std::uint64_t> buckets;
+	std::uint64_t count;
+	double total;
+	double minimum;
+	double maximum;
+};
+
+#endif /* QUANTILE_SKETCH_H */
@@ -0,0 +1,370 @@
+// Definition of the random number stream classes.
+
+#include <cmath> // std::log, std::sqrt, std::cos, std::sin
+
+// Include header file for the random number stream classes
+#include "RandomStream.h"
+
+// Constants of the Philox4x32 generator
+static const std::uint32_t philoxM0 = 0xD2511F53;
+static const std::uint32_t philoxM1 = 0xCD9E8D57;
+static const std::uint32_t philoxW0 = 0x9E3779B9; // Golden ratio
+static const std::uint32_t philoxW1 = 0xBB67AE85; // sqrt(3) - 1
+static const int philoxRounds = 10;
+
+static const double twoPi = 6.283185307179586476925286766559;
+
+// Default constructor
+RandomStream::RandomStream()
+{
+	reseed(0, 0, 0);
+}
+
+// Constructor for a particular stream of a particular replication
+RandomStream::RandomStream(std::uint64_t masterSeed, std::uint32_t streamID, std::uint32_t replication)
+{
+	reseed(masterSeed, streamID, replication);
+}
+
+// Restart the stream for a particular master seed, stream ID and replication
+void RandomStream::reseed(std::uint64_t masterSeed, std::uint32_t streamID, std::uint32_t replication, bool antitheticStream)
+{
+	key[0] = static_cast<std::uint32_t>(masterSeed);
+	key[1] = static_cast<std::uint32_t>(masterSeed >> 32);
+
+	counter[0] = 0;
+	counter[1] = 0;
+	counter[2] = streamID;
+	counter[3] = replication;
+
+	used = 0;
+	antithetic = antitheticStream;
+	hasSpareNormal = false;
+	spareNormal = 0;
+
+	generateBlock();
+}
+
+// Compute the block of 4 words for the current counter (10 rounds of Philox)
+void RandomStream::generateBlock()
+{
+	std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	std::uint32_t k0 = key[0], k1 = key[1];
+
+	for (int round = 0; round < philoxRounds; ++round) {
+		std::uint64_t product0 = static_cast<std::uint64_t>(philoxM0) * c0;
+		std::uint64_t product1 = static_cast<std::uint64_t>(philoxM1) * c2;
+
+		std::uint32_t hi0 = static_cast<std::uint32_t>(product0 >> 32);
+		std::uint32_t lo0 = static_cast<std::uint32_t>(product0);
+		std::uint32_t hi1 = static_cast<std::uint32_t>(product1 >> 32);
+		std::uint32_t lo1 = static_cast<std::uint32_t>(product1);
+
+		c0 = hi1 ^ c1 ^ k0;
+		c1 = lo1;
+		c2 = hi0 ^ c3 ^ k1;
+		c3 = lo0;
+
+		k0 += philoxW0;
+		k1 += philoxW1;
+	}
+
+	block[0] = c0;
+	block[1] = c1;
+	block[2] = c2;
+	block[3] = c3;
+}
+
+// Number of blocks computed together by the block kernels (64 uniforms). The rounds of Philox are computed
+// for all of them in the inner loop, which the compiler vectorizes (with fewer lanes, it only unrolls it).
+static const int philoxLanes = 32;
+
+// Compute the blocks of 4 words for the counters (firstBlock + lane, c2, c3) of all lanes
+static void generateBlocks(const std::uint32_t key[2], std::uint64_t firstBlock, std::uint32_t c2, std::uint32_t c3,
+	std::uint32_t out[4][philoxLanes])
+{
+	std::uint32_t x0[philoxLanes], x1[philoxLanes], x2[philoxLanes], x3[philoxLanes];
+	for (int lane = 0; lane < philoxLanes; ++lane) {
+		std::uint64_t blockNumber = firstBlock + lane;
+		x0[lane] = static_cast<std::uint32_t>(blockNumber);
+		x1[lane] = static_cast<std::uint32_t>(blockNumber >> 32);
+		x2[lane] = c2;
+		x3[lane] = c3;
+	}
+
+	std::uint32_t k0 = key[0], k1 = key[1];
+	for (int round = 0; round < philoxRounds; ++round) {
+		for (int lane = 0; lane < philoxLanes; ++lane) {
+			std::uint64_t product0 = static_cast<std::uint64_t>(philoxM0) * x0[lane];
+			std::uint64_t product1 = static_cast<std::uint64_t>(philoxM1) * x2[lane];
+
+			std::uint32_t hi0 = static_cast<std::uint32_t>(product0 >> 32);
+			std::uint32_t lo0 = static_cast<std::uint32_t>(product0);
+			std::uint32_t hi1 = static_cast<std::uint32_t>(product1 >> 32);
+			std::uint32_t lo1 = static_cast<std::uint32_t>(product1);
+
+			x0[lane] = hi1 ^ x1[lane] ^ k0;
+			x1[lane] = lo1;
+			x2[lane] = hi0 ^ x3[lane] ^ k1;
+			x3[lane] = lo0;
+		}
+
+		k0 += philoxW0;
+		k1 += philoxW1;
+	}
+
+	for (int lane = 0; lane < philoxLanes; ++lane) {
+		out[0][lane] = x0[lane];
+		out[1][lane] = x1[lane];
+		out[2][lane] = x2[lane];
+		out[3][lane] = x3[lane];
+	}
+}
+
+// Uniform on (0, 1) from two 32-bit words, combined into a 53-bit mantissa. Half of the last bit is
+// added so that 0 is never returned. The mantissa is converted as a signed integer (it is below 2^53, so
+// the value is the same), which is a single instruction where an unsigned conversion needs a branch.
+static inline double toUniform(std::uint32_t word0, std::uint32_t word1)
+{
+	std::uint64_t high = word0 >> 5; // 27 bits
+	std::uint64_t low = word1 >> 6;  // 26 bits
+	return (static_cast<double>(static_cast<std::int64_t>(high << 26 | low)) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Next uniform of the normal stream, on the open interval (0, 1). Each block holds two uniforms.
+// 1 - u is exact for these values, so the antithetic uniform is also in (0, 1).
+double RandomStream::nextUniform()
+{
+	if (used == 2) {
+		// Move to the next block
+		if (++counter[0] == 0)
+			++counter[1];
+		generateBlock();
+		used = 0;
+	}
+
+	double u = toUniform(block[2 * used], block[2 * used + 1]);
+	used++;
+	return u;
+}
+
+// Next n uniforms of the normal stream: the rest of the current block, then philoxLanes blocks at a time,
+// then one block at a time
+void RandomStream::nextUniforms(double *out, std::size_t n)
+{
+	std::size_t i = 0;
+	while (i < n && used < 2)
+		out[i++] = nextUniform();
+
+	if (n - i >= 2 * philoxLanes) {
+		std::uint64_t nextBlock = ((static_cast<std::uint64_t>(counter[1]) << 32) | counter[0]) + 1;
+		std::uint32_t words[4][philoxLanes];
+		while (n - i >= 2 * philoxLanes) {
+			generateBlocks(key, nextBlock, counter[2], counter[3], words);
+			for (int lane = 0; lane < philoxLanes; ++lane) {
+				out[i + 2 * lane] = toUniform(words[0][lane], words[1][lane]);
+				out[i + 2 * lane + 1] = toUniform(words[2][lane], words[3][lane]);
+			}
+			i += 2 * philoxLanes;
+			nextBlock += philoxLanes;
+		}
+
+		// The last block computed is used up: the next uniform starts a new block (the words in 'block' are
+		// not read again)
+		std::uint64_t lastBlock = nextBlock - 1;
+		counter[0] = static_cast<std::uint32_t>(lastBlock);
+		counter[1] = static_cast<std::uint32_t>(lastBlock >> 32);
+		used = 2;
+	}
+
+	while (i < n)
+		out[i++] = nextUniform();
+}
+
+// n calls to uniform()
+void RandomStream::uniforms(double *out, std::size_t n)
+{
+	nextUniforms(out, n);
+	if (antithetic) {
+		for (std::size_t i = 0; i < n; ++i)
+			out[i] = 1.0 - out[i];
+	}
+}
+
+// The logs of n calls to uniform(), for exponentials
+void RandomStream::logUniforms(double *out, std::size_t n)
+{
+	uniforms(out, n);
+	for (std::size_t i = 0; i < n; ++i)
+		out[i] = std::log(out[i]);
+}
+
+// n Box-Muller pairs, as computed by normal()
+void RandomStream::normalPairs(double *radius, double *cosine, double *spare, std::size_t n)
+{
+	const std::size_t chunk = 64;
+	double u[2 * chunk];
+	for (std::size_t first = 0; first < n; first += chunk) {
+		std::size_t count = (n - first < chunk) ? n - first : chunk;
+		nextUniforms(u, 2 * count);
+		for (std::size_t i = 0; i < count; ++i) {
+			double r = std::sqrt(-2.0 * std::log(u[2 * i]));
+			double angle = twoPi * u[2 * i + 1];
+			radius[first + i] = r;
+			cosine[first + i] = std::cos(angle);
+			spare[first + i] = r * std::sin(angle);
+		}
+	}
+}
+
+// Return a sample from the exponential distribution with mean 'mean' (inverse transform)
+double RandomStream::exponential(double mean)
+{
+	return -mean * std::log(uniform());
+}
+
+// Return a sample from the normal distribution with mean 'mean' and standard deviation 'sigma'
+// (Box-Muller transform). The antithetic stream mirrors the standard normals of the normal stream
+// (-z instead of z), since 1 - u in Box-Muller would not give negatively correlated normals.
+double RandomStream::normal(double mean, double sigma)
+{
+	double sign = antithetic ? -1.0 : 1.0;
+
+	if (hasSpareNormal) {
+		hasSpareNormal = false;
+		return mean + sign * sigma * spareNormal;
+	}
+
+	double radius = std::sqrt(-2.0 * std::log(nextUniform()));
+	double angle = twoPi * nextUniform();
+
+	spareNormal = radius * std::sin(angle);
+	hasSpareNormal = true;
+
+	return mean + sign * sigma * radius * std::cos(angle);
+}
+
+// Return true with probability p
+bool RandomStream::bernoulli(double p)
+{
+	return uniform() < p;
+}
+
+// Number of uniforms drawn so far
+std::uint64_t RandomStream::position() const
+{
+	std::uint64_t blockNumber = (static_cast<std::uint64_t>(counter[1]) << 32) | counter[0];
+	return 2 * blockNumber + used;
+}
+
+// Jump to any position in the stream
+void RandomStream::seek(std::uint64_t position)
+{
+	moveTo(position);
+	hasSpareNormal = false;
+}
+
+// Move to a position in the stream, keeping the spare normal
+void RandomStream::moveTo(std::uint64_t position)
+{
+	std::uint64_t blockNumber = position / 2;
+	counter[0] = static_cast<std::uint32_t>(blockNumber);
+	counter[1] = static_cast<std::uint32_t>(blockNumber >> 32);
+	generateBlock();
+
+	used = static_cast<std::uint32_t>(position % 2);
+}
+
+//////////////////////////////////////////////////
+//             BufferedRandomStream             //
+//////////////////////////////////////////////////
+
+BufferedRandomStream::BufferedRandomStream()
+	: buffer(3 * 64), blockSize(64), kind(KIND_NONE), next(0), end(0), antithetic(false), hasSpareNormal(false), spareNormal(0)
+{
+}
+
+void BufferedRandomStream::reseed(std::uint64_t masterSeed, std::uint32_t streamID, std::uint32_t replication, bool antitheticStream)
+{
+	generator.reseed(masterSeed, streamID, replication, antitheticStream);
+	antithetic = antitheticStream;
+	kind = KIND_NONE;
+	next = 0;
+	end = 0;
+	hasSpareNormal = false;
+	spareNormal = 0;
+}
+
+// Change the block size, keeping the position in the stream
+void BufferedRandomStream::setBlockSize(std::size_t size)
+{
+	generator.moveTo(position());
+	kind = KIND_NONE;
+	next = 0;
+	end = 0;
+
+	blockSize = (size > 0) ? size : 1;
+	buffer.resize(3 * blockSize);
+}
+
+// Fill the buffer with a block of variates of a kind. The variates left in the buffer are dropped, and the
+// generator moves back to the first uniform they used.
+void BufferedRandomStream::refill(Kind newKind)
+{
+	if (next < end)
+		generator.moveTo(position());
+
+	switch (newKind) {
+	case KIND_UNIFORM:
+		generator.uniforms(&buffer[0], blockSize);
+		break;
+	case KIND_EXPONENTIAL:
+		generator.logUniforms(&buffer[0], blockSize);
+		break;
+	case KIND_NORMAL:
+		generator.normalPairs(&buffer[0], &buffer[blockSize], &buffer[2 * blockSize], blockSize);
+		break;
+	case KIND_NONE:
+		break;
+	}
+
+	kind = newKind;
+	next = 0;
+	end = blockSize;
+}
+
+// Number of uniforms drawn so far: those of the generator, less those of the variates left in the buffer
+std::uint64_t BufferedRandomStream::position() const
+{
+	return generator.position() - (end - next) * uniformsPerVariate(kind);
+}
+
+void BufferedRandomStream::seek(std::uint64_t position)
+{
+	generator.seek(position);
+	kind = KIND_NONE;
+	next = 0;
+	end = 0;
+	hasSpareNormal = false;
+}
+
+// The RandomStream at the same position, with the same spare normal
+RandomStream BufferedRandomStream::state() const
+{
+	RandomStream stream(generator);
+	stream.moveTo(position());
+	stream.hasSpareNormal = hasSpareNormal;
+	stream.spareNormal = spareNormal;
+	return stream;
+}
+
+void BufferedRandomStream::restore(const RandomStream &stream)
+{
+	generator = stream;
+	antithetic = stream.antithetic;
+	kind = KIND_NONE;
+	next = 0;
+	end = 0;
+	hasSpareNormal = stream.hasSpareNormal;
+	spareNormal = stream.spareNormal;
+}
@@ -0,0 +1,248 @@
+// Header file for the random number stream classes
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Identifiers of the random number streams used by the reference plant. Every stochastic source in the
+// plant draws from its own stream, so a change in one part of the model does not shift the
+// random numbers seen by the others. Two scenarios run with the same master seed and replication
+// therefore see the same arrivals, inspections and service draws (common random numbers).
+// Any PlantModel numbers its streams in the same order (see PlantModel::assignStreams).
+enum StreamID {
+	// Interarrival times of the 5 parts
+	STREAM_ARRIVAL_RODEND,
+	STREAM_ARRIVAL_PISTON,
+	STREAM_ARRIVAL_CYLINDERCAP,
+	STREAM_ARRIVAL_CYLINDER,
+	STREAM_ARRIVAL_CYLINDERRODEND,
+
+	// Acceptance/rejection of the 5 parts at their receiving inspection
+	STREAM_INSPECT_RODEND,
+	STREAM_INSPECT_PISTON,
+	STREAM_INSPECT_CYLINDERCAP,
+	STREAM_INSPECT_CYLINDER,
+	STREAM_INSPECT_CYLINDERRODEND,
+
+	// Service times of the stations
+	STREAM_SERVICE_ASSEMBLY,
+	STREAM_SERVICE_COATING,
+	STREAM_SERVICE_REWORK,
+
+	// Acceptance/rejection of Assembly entities at the assembly-level inspection
+	STREAM_INSPECT_ASSEMBLY,
+
+	NUM_STREAMS
+};
+
+// A stream of random numbers produced by the Philox4x32-10 counter-based generator
+// (Salmon et al., 2011). The i-th number of a stream is a pure function of
+// (master seed, stream ID, replication, i), so:
+// - streams for different (stream ID, replication) pairs never overlap,
+// - a stream can jump ahead to any position in O(1),
+// - results are bit-reproducible on every platform and independent of thread scheduling.
+// A stream holds 40 bytes of state and is cheap to create and copy.
+class RandomStream {
+public:
+	// Default constructor (master seed 0, stream 0, replication 0)
+	RandomStream();
+
+	// Constructor for a particular stream of a particular replication
+	RandomStream(std::uint64_t masterSeed, std::uint32_t streamID, std::uint32_t replication);
+
+	// Restart the stream for a particular master seed, stream ID and replication. An antithetic stream
+	// returns 1 - u for every uniform u of the normal stream (and -z for every standard normal z).
+	void reseed(std::uint64_t masterSeed, std::uint32_t streamID, std::uint32_t replication, bool antithetic = false);
+
+	// Return a sample from the uniform distribution on the open interval (0, 1)
+	double uniform() { return antithetic ? 1.0 - nextUniform() : nextUniform(); }
+
+	// Return a sample from the exponential distribution with mean 'mean'
+	double exponential(double mean);
+
+	// Return a sample from the normal distribution with mean 'mean' and standard deviation 'sigma'
+	double normal(double mean, double sigma);
+
+	// Return true with probability p
+	bool bernoulli(double p);
+
+	// Number of uniforms drawn so far, and jump ahead/back to any position in the stream
+	std::uint64_t position() const;
+	void seek(std::uint64_t);
+
+	// Skip the next n uniforms
+	void skip(std::uint64_t n) { seek(position() + n); }
+
+	// Block kernels: draw n variates at once, exactly as n calls would, several generator blocks at a time.
+	// uniforms() is n calls to uniform() and logUniforms() the log of each; normalPairs() is n pairs of calls
+	// to normal(0, 1) starting without a spare normal (radius * cosine, then the spare), not mirrored for an
+	// antithetic stream.
+	void uniforms(double *out, std::size_t n);
+	void logUniforms(double *out, std::size_t n);
+	void normalPairs(double *radius, double *cosine, double *spare, std::size_t n);
+
+private:
+	friend class BufferedRandomStream; // Converts to and from a RandomStream with its spare normal
+
+	// Compute the block of 4 words for the current counter
+	void generateBlock();
+
+	// Next n uniforms of the normal (not antithetic) stream, generated several blocks at a time
+	void nextUniforms(double *out, std::size_t n);
+
+	// Move to a position in the stream, keeping the spare normal
+	void moveTo(std::uint64_t position);
+
+	// Next uniform of the normal (not antithetic) stream
+	double nextUniform();
+
+	std::uint32_t key[2];     // From the master seed
+	std::uint32_t counter[4]; // Block number (2 words), stream ID and replication
+	std::uint32_t block[4];   // Output of the generator for the current counter
+	std::uint32_t used;       // Number of uniforms already taken from the current block (0, 1 or 2)
+	bool antithetic;
+
+	// Box-Muller produces normals in pairs. The second one is kept for the next call.
+	bool hasSpareNormal;
+	double spareNormal;
+};
+
+// A RandomStream that draws its variates from a buffer refilled in blocks by the block kernels of
+// RandomStream: generating many numbers at once is cheaper than one at a time, and the loops of the
+// kernels can be vectorized by the compiler. The buffer holds variates of the kind last drawn (uniforms,
+// logs of uniforms for exponentials, or Box-Muller pairs for normals). Drawing another kind discards the
+// rest of the buffer and moves the generator back to the first number not yet used, so the stream returns
+// exactly the same variates as a RandomStream, whatever the block size.
+class BufferedRandomStream {
+public:
+	BufferedRandomStream();
+
+	void reseed(std::uint64_t masterSeed, std::uint32_t streamID, std::uint32_t replication, bool antithetic = false);
+
+	// Number of variates generated per refill (default 64). Changes the speed, not the variates.
+	void setBlockSize(std::size_t size);
+
+	double uniform()
+	{
+		if (kind != KIND_UNIFORM || next == end)
+			refill(KIND_UNIFORM);
+		return buffer[next++];
+	}
+
+	double exponential(double mean)
+	{
+		if (kind != KIND_EXPONENTIAL || next == end)
+			refill(KIND_EXPONENTIAL);
+		return -mean * buffer[next++];
+	}
+
+	double normal(double mean, double sigma)
+	{
+		double sign = antithetic ? -1.0 : 1.0;
+
+		if (hasSpareNormal) {
+			hasSpareNormal = false;
+			return mean + sign * sigma * spareNormal;
+		}
+
+		if (kind != KIND_NORMAL || next == end)
+			refill(KIND_NORMAL);
+
+		std::size_t i = next++;
+		spareNormal = buffer[2 * blockSize + i];
+		hasSpareNormal = true;
+
+		return mean + sign * sigma * buffer[i] * buffer[blockSize + i];
+	}
+
+	bool bernoulli(double p) { return uniform() < p; }
+
+	std::uint64_t position() const;
+	void seek(std::uint64_t);
+
+	// The equivalent RandomStream (e.g. for a Snapshot), and restart from a RandomStream
+	RandomStream state() const;
+	void restore(const RandomStream &);
+
+private:
+	// Kind of the variates in the buffer
+	enum Kind {
+		KIND_NONE,
+		KIND_UNIFORM,     // Uniforms
+		KIND_EXPONENTIAL, // Logs of uniforms
+		KIND_NORMAL       // Box-Muller pairs: the radii, then the cosines, then the spare normals
+	};
+
+	// Fill the buffer with a block of variates of a kind
+	void refill(Kind);
+
+	// Uniforms of the generator used by each variate of a kind
+	static std::uint64_t uniformsPerVariate(Kind k) { return (k == KIND_NORMAL) ? 2 : (k == KIND_NONE) ? 0 : 1; }
+
+	RandomStream generator; // Positioned after the variates in the buffer
+	std::vector<double> buffer;
+	std::size_t blockSize;
+	Kind kind;
+	std::size_t next;       // Next variate in the buffer
+	std::size_t end;        // Number of variates in the buffer
+	bool antithetic;
+	bool hasSpareNormal;
+	double spareNormal;
+};
+
+// The set of all streams used by one replication of the model. There are NUM_STREAMS streams unless
+// the model asks for another number (see PlantModel::numStreams).
+class RandomStreams {
+public:
+	RandomStreams() : streams(NUM_STREAMS) {}
+	RandomStreams(std::uint64_t masterSeed, std::uint32_t replication) : streams(NUM_STREAMS) { reseed(masterSeed, replication); }
+
+	// Change the number of streams. New streams must be reseeded before use.
+	void resize(std::size_t numStreams) { streams.resize(numStreams); }
+	std::size_t size() const { return streams.size(); }
+
+	// Restart all streams for a particular master seed and replication, optionally as antithetic streams
+	void reseed(std::uint64_t masterSeed, std::uint32_t replication, bool antithetic = false)
+	{
+		for (std::size_t s = 0; s < streams.size(); ++s)
+			streams[s].reseed(masterSeed, static_cast<std::uint32_t>(s), replication, antithetic);
+	}
+
+	RandomStream &operator[](int id) { return streams[id]; }
+	const RandomStream &operator[](int id) const { return streams[id]; }
+
+	// State of a stream, and restart a stream from a state (e.g. for a Snapshot)
+	RandomStream state(int id) const { return streams[id]; }
+	void restore(int id, const RandomStream &stream) { streams[id] = stream; }
+
+private:
+	std::vector<RandomStream> streams;
+};
+
+// The same set of streams, drawing from buffered streams. Gives exactly the same variates as RandomStreams.
+class BufferedRandomStreams {
+public:
+	BufferedRandomStreams() : streams(NUM_STREAMS) {}
+
+	void resize(std::size_t numStreams) { streams.resize(numStreams); }
+	std::size_t size() const { return streams.size(); }
+
+	void reseed(std::uint64_t masterSeed, std::uint32_t replication, bool antithetic = false)
+	{
+		for (std::size_t s = 0; s < streams.size(); ++s)
+			streams[s].reseed(masterSeed, static_cast<std::uint32_t>(s), replication, antithetic);
+	}
+
+	BufferedRandomStream &operator[](int id) { return streams[id]; }
+	const BufferedRandomStream &operator[](int id) const { return streams[id]; }
+
+	RandomStream state(int id) const { return streams[id].state(); }
+	void restore(int id, const RandomStream &stream) { streams[id].restore(stream); }
+
+private:
+	std::vector<BufferedRandomStream> streams;
+};
+
+#endif /* RANDOM_STREAM_H */
@@ -0,0 +1,293 @@
+// Definition of the ranking and selection of the best scenario.
+
+#include <cmath>
+#include <algorithm> // std::max, std::min
+
+// Include header file for the ranking and selection
+#include "RankingSelection.h"
+
+// Observations of the statistic of interest of every scenario, on a scale where larger is better. An
+// observation is the average of a group of replications (a pair with antithetic pairs); observation l of
+// a scenario is made of replications l * group, ..., (l + 1) * group - 1.
+class ObservationTable {
+public:
+	ObservationTable(const std::vector<ModelParameters> &scenarioParams, const SelectionSettings &selection)
+		: scenarios(scenarioParams), settings(selection), values(scenarioParams.size()), sums(scenarioParams.size(), std::vector<double>(1, 0)),
+		groupSums(scenarioParams.size(), 0), inGroup(scenarioParams.size(), 0), replicationsRun(0) {}
+
+	// Run replications until every scenario s has at least wanted[s] observations
+	void extend(ReplicationRunner &runner, const SimulationOptions &options, const std::vector<int> &wanted, const ScenarioConsumer &consume)
+	{
+		std::vector<int> first, count;
+		for (std::size_t s = 0; s < scenarios.size(); ++s) {
+			int group = groupSize(s);
+			first.push_back(this->count(static_cast<int>(s)) * group);
+			count.push_back(std::max(wanted[s] - this->count(static_cast<int>(s)), 0) * group);
+			replicationsRun += count.back();
+		}
+
+		runner.runScenarios(scenarios, first, count, options, [&](int s, ReplicationOutput &output) {
+			groupSums[s] += metricValue(output.result, settings.metric);
+			if (++inGroup[s] == groupSize(s)) {
+				double observation = groupSums[s] / inGroup[s];
+				add(s, settings.maximize ? observation : -observation);
+				groupSums[s] = 0;
+				inGroup[s] = 0;
+			}
+			consume(s, output);
+		});
+	}
+
+	int count(int s) const { return static_cast<int>(values[s].size()); }
+	double value(int s, int l) const { return values[s][l]; }
+
+	// Mean of the first n observations of a scenario
+	double mean(int s, int n) const { return sums[s][n] / n; }
+
+	// Mean and variance of all observations of a scenario
+	RunningStatistics statistics(int s) const
+	{
+		RunningStatistics statistic;
+		for (std::size_t l = 0; l < values[s].size(); ++l)
+			statistic.add(values[s][l]);
+		return statistic;
+	}
+
+	int replications() const { return replicationsRun; }
+
+private:
+	int groupSize(std::size_t s) const { return scenarios[s].antitheticPairs ? 2 : 1; }
+
+	void add(int s, double observation)
+	{
+		values[s].push_back(observation);
+		sums[s].push_back(sums[s].back() + observation);
+	}
+
+	const std::vector<ModelParameters> &scenarios;
+	const SelectionSettings &settings;
+	std::vector<std::vector<double> > values;
+	std::vector<std::vector<double> > sums; // sums[s][n]: sum of the first n observations
+	std::vector<double> groupSums;          // Sum of the replications of the group being completed
+	std::vector<int> inGroup;
+	int replicationsRun;
+};
+
+// Standard normal distribution function
+static double normalCdf(double x)
+{
+	return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+// Fill the number of observations used and the means of a result, back on the scale of the statistic
+static void fillMeans(const ObservationTable &table, const SelectionSettings &settings, SelectionResult &result)
+{
+	result.means.clear();
+	for (std::size_t s = 0; s < result.observations.size(); ++s) {
+		double mean = table.mean(static_cast<int>(s), result.observations[s]);
+		result.means.push_back(settings.maximize ? mean : -mean);
+	}
+	result.replicationsRun = table.replications();
+}
+
+// KN: screen the scenarios left after every observation, until one is left
+static SelectionResult selectKN(ReplicationRunner &runner, const std::vector<ModelParameters> &scenarios, const SimulationOptions &options,
+	const SelectionSettings &settings, const ScenarioConsumer &consume)
+{
+	int k = static_cast<int>(scenarios.size());
+	int n0 = std::max(settings.initialObservations, 2);
+	ObservationTable table(scenarios, settings);
+	table.extend(runner, options, std::vector<int>(k, n0), consume);
+
+	// Constant of the continuation region, for the first stage of n0 observations
+	double alpha = 1 - settings.confidence;
+	double delta = settings.indifferenceZone;
+	double eta = (k > 1) ? 0.5 * (std::pow(2 * alpha / (k - 1), -2.0 / (n0 - 1)) - 1) : 0;
+	double h2 = 2 * eta * (n0 - 1);
+
+	// Variance of the difference of every pair of scenarios over the first stage (common random numbers make
+	// it smaller than the sum of their variances)
+	std::vector<std::vector<double> > differenceVariance(k, std::vector<double>(k, 0));
+	for (int i = 0; i < k; ++i) {
+		for (int l = i + 1; l < k; ++l) {
+			double meanDifference = table.mean(i, n0) - table.mean(l, n0);
+			double sum = 0;
+			for (int j = 0; j < n0; ++j) {
+				double deviation = table.value(i, j) - table.value(l, j) - meanDifference;
+				sum += deviation * deviation;
+			}
+			differenceVariance[i][l] = differenceVariance[l][i] = sum / (n0 - 1);
+		}
+	}
+
+	SelectionResult result;
+	result.eliminatedAfter.assign(k, 0);
+	std::vector<int> contenders;
+	for (int i = 0; i < k; ++i)
+		contenders.push_back(i);
+
+	int r = n0;
+	while (1) {
+
+		// Eliminate the scenarios whose mean after r observations is below that of another by more than the
+		// half-width of the continuation region
+		std::vector<int> survivors;
+		for (std::size_t a = 0; a < contenders.size(); ++a) {
+			int i = contenders[a];
+			bool eliminated = false;
+			for (std::size_t b = 0; b < contenders.size() && !eliminated; ++b) {
+				int l = contenders[b];
+				if (l == i)
+					continue;
+				double w = std::max(0.0, delta / (2 * r) * (h2 * differenceVariance[i][l] / (delta * delta) - r));
+				eliminated = table.mean(i, r) < table.mean(l, r) - w;
+			}
+
+			if (eliminated)
+				result.eliminatedAfter[i] = r;
+			else
+				survivors.push_back(i);
+		}
+		contenders = survivors;
+
+		if (contenders.size() == 1 || r >= settings.maxObservations)
+			break;
+
+		// The next observations of the scenarios left, taken a few at a time so that all threads are busy.
+		// Screening still looks at one more observation at a time, so the decision is the same.
+		r++;
+		if (table.count(contenders[0]) < r) {
+			int batch = std::max(1, static_cast<int>(2 * runner.numThreads() / contenders.size()));
+			std::vector<int> wanted(k, 0);
+			for (std::size_t a = 0; a < contenders.size(); ++a)
+				wanted[contenders[a]] = std::min(r - 1 + batch, std::max(settings.maxObservations, r));
+			table.extend(runner, options, wanted, consume);
+		}
+	}
+
+	// The best mean among the scenarios left (the only one, unless the maximum number of observations was reached)
+	result.best = contenders[0];
+	for (std::size_t a = 1; a < contenders.size(); ++a) {
+		if (table.mean(contenders[a], r) > table.mean(result.best, r))
+			result.best = contenders[a];
+	}
+
+	for (int i = 0; i < k; ++i)
+		result.observations.push_back(result.eliminatedAfter[i] ? result.eliminatedAfter[i] : r);
+	fillMeans(table, settings, result);
+	result.probabilityCorrect = settings.confidence;
+	return result;
+}
+
+// OCBA: allocate rounds of observations in the ratios that maximize the approximate probability of correct selection
+static SelectionResult selectOCBA(ReplicationRunner &runner, const std::vector<ModelParameters> &scenarios, const SimulationOptions &options,
+	const SelectionSettings &settings, const ScenarioConsumer &consume)
+{
+	int k = static_cast<int>(scenarios.size());
+	int n0 = std::max(settings.initialObservations, 2);
+	ObservationTable table(scenarios, settings);
+	table.extend(runner, options, std::vector<int>(k, n0), consume);
+
+	int total = k * n0;
+	std::vector<double> means(k), variances(k);
+	int best = 0;
+	while (1) {
+		best = 0;
+		for (int i = 0; i < k; ++i) {
+			RunningStatistics statistic = table.statistics(i);
+			means[i] = statistic.mean();
+			variances[i] = statistic.variance();
+			if (means[i] > means[best])
+				best = i;
+		}
+
+		if (total >= settings.budget || k == 1)
+			break;
+
+		// Ratios of the allocation: N_i proportional to (sigma_i / d_i)^2 for the other scenarios, with d_i the
+		// difference of their mean with the best, and N_b = sigma_b * sqrt(sum N_i^2 / sigma_i^2). The
+		// scenarios are taken as independent, which overstates the variances of the differences under
+		// common random numbers.
+		std::vector<double> ratio(k, 0);
+		double ratioSum = 0;
+		double bestSum = 0;
+		for (int i = 0; i < k; ++i) {
+			if (i == best)
+				continue;
+			double d = std::max(means[best] - means[i], 1e-12 * (std::fabs(means[best]) + 1));
+			ratio[i] = variances[i] / (d * d);
+			bestSum += variances[i] / (d * d * d * d);
+			ratioSum += ratio[i];
+		}
+		ratio[best] = std::sqrt(variances[best] * bestSum);
+		ratioSum += ratio[best];
+		if (ratioSum == 0)
+			break; // No variance: more observations would not change anything
+
+		// Observations still missing to reach the allocation of the new total, and the share of this round of each scenario
+		int increment = std::min(std::max(settings.increment, 1), settings.budget - total);
+		double newTotal = total + increment;
+		std::vector<double> shortfall(k);
+		double shortfallSum = 0;
+		for (int i = 0; i < k; ++i) {
+			shortfall[i] = std::max(newTotal * ratio[i] / ratioSum - table.count(i), 0.0);
+			shortfallSum += shortfall[i];
+		}
+		if (shortfallSum == 0) {
+			shortfall = ratio;
+			shortfallSum = ratioSum;
+		}
+
+		// Whole observations, with what is left of the round given to the largest remainders
+		std::vector<int> wanted(k);
+		std::vector<double> remainder(k);
+		int allocated = 0;
+		for (int i = 0; i < k; ++i) {
+			double share = increment * shortfall[i] / shortfallSum;
+			int whole = static_cast<int>(std::floor(share));
+			wanted[i] = table.count(i) + whole;
+			remainder[i] = share - whole;
+			allocated += whole;
+		}
+		for (; allocated < increment; ++allocated) {
+			int largest = 0;
+			for (int i = 1; i < k; ++i) {
+				if (remainder[i] > remainder[largest])
+					largest = i;
+			}
+			wanted[largest]++;
+			remainder[largest] = -1;
+		}
+
+		table.extend(runner, options, wanted, consume);
+		total += increment;
+	}
+
+	SelectionResult result;
+	result.best = best;
+	result.eliminatedAfter.assign(k, 0);
+	for (int i = 0; i < k; ++i)
+		result.observations.push_back(table.count(i));
+	fillMeans(table, settings, result);
+
+	// APCS-B: one minus the sum of the approximate probabilities that each other scenario is better than the best
+	double incorrect = 0;
+	for (int i = 0; i < k; ++i) {
+		if (i == best)
+			continue;
+		double spread = std::sqrt(variances[best] / table.count(best) + variances[i] / table.count(i));
+		double d = means[best] - means[i];
+		incorrect += (spread > 0) ? normalCdf(-d / spread) : (d > 0 ? 0 : 0.5);
+	}
+	result.probabilityCorrect = std::max(1 - incorrect, 0.0);
+	return result;
+}
+
+// Select the best scenario with the procedure of the settings
+SelectionResult selectBest(ReplicationRunner &runner, const std::vector<ModelParameters> &scenarios, const SimulationOptions &options,
+	const SelectionSettings &settings, const ScenarioConsumer &consume)
+{
+	if (settings.procedure == SELECTION_OCBA)
+		return selectOCBA(runner, scenarios, options, settings, consume);
+	return selectKN(runner, scenarios, options, settings, consume);
+}
@@ -0,0 +1,65 @@
+// Header file for the ranking and selection of the best scenario
+#ifndef RANKING_SELECTION_H
+#define RANKING_SELECTION_H
+
+#include <vector>
+
+#include "ModelParameters.h"
+#include "OutputAnalysis.h"
+#include "ReplicationRunner.h"
+
+// Procedures that choose the best of several scenarios (systems) for one statistic of interest, running
+// more replications of the scenarios that are hard to tell apart rather than the same number of all.
+// Replication i of every scenario uses the same random numbers (common random numbers), which both
+// procedures take into account. With antithetic pairs, an observation is the average of a pair.
+enum SelectionProcedure {
+	// Fully sequential procedure KN (Kim and Nelson, 2001). After 'initialObservations' observations of every
+	// scenario, one observation of every scenario still in contention is added at a time, and a scenario is
+	// eliminated as soon as its mean is clearly worse than that of another. The scenario selected is the best
+	// with probability at least 'confidence' if the best is better than all others by 'indifferenceZone' or more.
+	SELECTION_KN,
+
+	// Optimal Computing Budget Allocation (Chen et al., 2000). After 'initialObservations' observations of every
+	// scenario, rounds of 'increment' observations are allocated to the scenarios that most increase the
+	// approximate probability of correct selection (APCS-B), until 'budget' observations in all were taken.
+	SELECTION_OCBA
+};
+
+// What is selected, and how
+struct SelectionSettings {
+	SelectionSettings() : procedure(SELECTION_KN), metric(METRIC_TIME_IN_SYSTEM), maximize(false), initialObservations(10),
+		confidence(0.95), indifferenceZone(1), maxObservations(10000), budget(1000), increment(20) {}
+
+	SelectionProcedure procedure;
+	ResultMetric metric; // Statistic of interest that decides which scenario is best
+	bool maximize;       // Whether the best scenario has the largest mean (otherwise the smallest)
+	int initialObservations;
+
+	// KN: probability of correct selection, indifference zone (in the units of the statistic), and number of
+	// observations of a scenario after which the scenario with the best mean is selected among those left
+	double confidence;
+	double indifferenceZone;
+	int maxObservations;
+
+	// OCBA: total number of observations of all scenarios, and number added in each round
+	int budget;
+	int increment;
+};
+
+// Outcome of a selection
+struct SelectionResult {
+	int best;                            // Index of the scenario selected
+	std::vector<int> observations;       // Number of observations of each scenario that the decision used
+	std::vector<double> means;           // Mean of the statistic of each scenario over those observations
+	std::vector<int> eliminatedAfter;    // KN: number of observations after which each scenario was eliminated (0 if not)
+	int replicationsRun;                 // Number of replications run, of all scenarios
+	double probabilityCorrect;           // KN: the confidence asked for. OCBA: APCS-B at the end.
+};
+
+// Select the best scenario. Replications are run on the runner in batches that keep its threads busy, and
+// every output is handed to the consumer, in order of scenario and replication within each batch. The
+// decision does not depend on the number of threads.
+SelectionResult selectBest(ReplicationRunner &, const std::vector<ModelParameters> &scenarios, const SimulationOptions &,
+	const SelectionSettings &, const ScenarioConsumer &);
+
+#endif /* RANKING_SELECTION_H */
@@ -0,0 +1,198 @@
+// Definition of class ReplicationRunner.
+
+#include <vector>
+#include <algorithm> // std::min, std::max, std::upper_bound
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+// Include header file for class ReplicationRunner
+#include "ReplicationRunner.h"
+
+// Constructor
+ReplicationRunner::ReplicationRunner(unsigned numThreads) : pool(numThreads), cache(0) {}
+
+// Whether the results cache is used
+bool ReplicationRunner::usesCache(const SimulationOptions &options) const
+{
+	return cache && cache->isOpen() && options.traceLevel == TRACE_NONE && !Instrumentation::enabled;
+}
+
+// Number of jobs run at once when every job keeps 'threadsPerJob' threads busy, so that they do not share cores
+int ReplicationRunner::jobsAtOnce(int threadsPerJob) const
+{
+	if (threadsPerJob <= 1)
+		return static_cast<int>(numThreads());
+
+	int cores = static_cast<int>(ThreadPool::resolveThreadCount(0));
+	return std::max(1, std::min(static_cast<int>(numThreads()), cores / threadsPerJob));
+}
+
+// Run a block of replications and hand back their outputs in order
+void ReplicationRunner::run(const ModelParameters &params, const SimulationOptions &options, int first, int count,
+	const ReplicationConsumer &consume, const Snapshot *warmStart)
+{
+	// Outputs found in the results cache, looked up before the jobs start since the cache is not shared
+	// between threads. The jobs of those replications only copy them.
+	bool cached = !warmStart && usesCache(options);
+	std::vector<std::uint64_t> keys;
+	std::vector<std::unique_ptr<ReplicationOutput> > cachedOutputs(count);
+	if (cached) {
+		std::uint64_t scenario = ResultsCache::scenarioKey(params);
+		for (int i = 0; i < count; ++i) {
+			keys.push_back(ResultsCache::replicationKey(scenario, first + i));
+			std::unique_ptr<ReplicationOutput> output(new ReplicationOutput);
+			if (cache->find(keys[i], *output))
+				cachedOutputs[i] = std::move(output);
+		}
+	}
+
+	// Consume an output, and store it in the cache if it was run
+	auto consumeAndStore = [&](int i, ReplicationOutput &output) {
+		if (cached && !cachedOutputs[i])
+			cache->store(keys[i], output);
+		consume(output);
+	};
+
+	// Each replication runs in its own Simulation object, on several threads if it is split over logical
+	// processes. Forks share the snapshot, which they only read.
+	int threadsPerJob = warmStart ? 1 : Simulation(params, options).logicalProcesses();
+	runJobs(count, jobsAtOnce(threadsPerJob), [&](int i) {
+		if (cachedOutputs[i])
+			return *cachedOutputs[i];
+		Simulation simulation(params, options);
+		if (warmStart)
+			return simulation.run(first + i, *warmStart, SNAPSHOT_FORK);
+		return simulation.run(first + i);
+	}, consumeAndStore);
+}
+
+// Run all replications of all scenarios and hand back their outputs in order
+void ReplicationRunner::runScenarios(const std::vector<ModelParameters> &scenarios, const SimulationOptions &options,
+	const ScenarioConsumer &consume)
+{
+	std::vector<int> first(scenarios.size(), 0);
+	std::vector<int> count;
+	for (std::size_t s = 0; s < scenarios.size(); ++s)
+		count.push_back(scenarios[s].numSimulations);
+
+	runScenarios(scenarios, first, count, options, consume);
+}
+
+// Run some replications of every scenario and hand back their outputs in order
+void ReplicationRunner::runScenarios(const std::vector<ModelParameters> &scenarios, const std::vector<int> &first,
+	const std::vector<int> &count, const SimulationOptions &options, const ScenarioConsumer &consume)
+{
+	// Job number of the first replication of each scenario
+	std::vector<int> firstJob(scenarios.size() + 1, 0);
+	for (std::size_t s = 0; s < scenarios.size(); ++s)
+		firstJob[s + 1] = firstJob[s] + std::max(count[s], 0);
+
+	// Scenario of a job
+	auto scenarioOf = [&](int job) {
+		return static_cast<int>(std::upper_bound(firstJob.begin(), firstJob.end(), job) - firstJob.begin()) - 1;
+	};
+
+	// Outputs found in the results cache (see run)
+	bool cached = usesCache(options);
+	std::vector<std::uint64_t> keys;
+	std::vector<std::unique_ptr<ReplicationOutput> > cachedOutputs(firstJob.back());
+	if (cached) {
+		for (std::size_t s = 0; s < scenarios.size(); ++s) {
+			std::uint64_t scenario = ResultsCache::scenarioKey(scenarios[s]);
+			for (int job = firstJob[s]; job < firstJob[s + 1]; ++job) {
+				keys.push_back(ResultsCache::replicationKey(scenario, first[s] + job - firstJob[s]));
+				std::unique_ptr<ReplicationOutput> output(new ReplicationOutput);
+				if (cache->find(keys[job], *output))
+					cachedOutputs[job] = std::move(output);
+			}
+		}
+	}
+
+	int threadsPerJob = 1;
+	for (std::size_t s = 0; s < scenarios.size(); ++s)
+		threadsPerJob = std::max(threadsPerJob, Simulation(scenarios[s], options).logicalProcesses());
+
+	runJobs(firstJob.back(), jobsAtOnce(threadsPerJob), [&](int job) {
+		if (cachedOutputs[job])
+			return *cachedOutputs[job];
+		int s = scenarioOf(job);
+		Simulation simulation(scenarios[s], options);
+		return simulation.run(first[s] + job - firstJob[s]);
+	}, [&](int job, ReplicationOutput &output) {
+		if (cached && !cachedOutputs[job])
+			cache->store(keys[job], output);
+		consume(scenarioOf(job), output);
+	});
+}
+
+// Run jobs on the pool and hand back their outputs in order. At most 'maxRunning' jobs are submitted at once:
+// each job submits the one 'maxRunning' places after it when it ends.
+void ReplicationRunner::runJobs(int count, int maxRunning, const std::function<ReplicationOutput(int)> &job,
+	const std::function<void(int, ReplicationOutput &)> &consume)
+{
+	// Outputs of the jobs that have finished but have not been consumed yet
+	std::vector<std::unique_ptr<ReplicationOutput> > outputs(count);
+	std::mutex outputMutex;
+	std::condition_variable outputReady;
+
+	std::function<void(int)> submit = [&](int i) {
+		pool.submit([&, i] {
+			std::unique_ptr<ReplicationOutput> output(new ReplicationOutput(job(i)));
+			{
+				std::lock_guard<std::mutex> lock(outputMutex);
+				outputs[i] = std::move(output);
+				outputReady.notify_one();
+			}
+			if (i + maxRunning < count)
+				submit(i + maxRunning);
+		});
+	};
+	for (int i = 0; i < count && i < maxRunning; ++i)
+		submit(i);
+
+	// Consume the outputs in order of job, as soon as they are available
+	for (int i = 0; i < count; ++i) {
+		std::unique_ptr<ReplicationOutput> output;
+		{
+			std::unique_lock<std::mutex> lock(outputMutex);
+			outputReady.wait(lock, [&] { return outputs[i] != 0; });
+			output = std::move(outputs[i]);
+		}
+		consume(i, *output);
+	}
+
+	pool.wait();
+}
+
+// Run replications until the stopping rule is satisfied
+int ReplicationRunner::runSequential(const ModelParameters &params, const SimulationOptions &options, const StoppingRule &rule,
+	ReplicationStatistics &statistics, const ReplicationConsumer &consume, const Snapshot *warmStart)
+{
+	int batchSize = std::max(2 * static_cast<int>(numThreads()), 1);
+	int launched = 0;
+	int consumed = 0;
+	bool stopped = false;
+
+	while (!stopped && launched < rule.maxReplications) {
+
+		// The first batch runs the minimum number of replications at once
+		int count = std::min(std::max(batchSize, rule.minReplications - launched), rule.maxReplications - launched);
+
+		run(params, options, launched, count, [&](ReplicationOutput &output) {
+			if (stopped)
+				return;
+
+			statistics.add(output.result);
+			consume(output);
+			consumed++;
+
+			if (statistics.meets(rule))
+				stopped = true;
+		}, warmStart);
+
+		launched += count;
+	}
+
+	return consumed;
+}
@@ -0,0 +1,75 @@
+// Header file for class ReplicationRunner
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include <functional>
+#include <vector>
+
+#include "Simulation.h"
+#include "OutputAnalysis.h"
+#include "ThreadPool.h"
+#include "ResultsCache.h"
+
+// Function called with the output of each simulation
+typedef std::function<void(ReplicationOutput &)> ReplicationConsumer;
+
+// Function called with the output of each simulation of a scenario (the index of the scenario comes first)
+typedef std::function<void(int, ReplicationOutput &)> ScenarioConsumer;
+
+// Runs independent replications of the model on all cores. Replications are dispatched to a
+// work-stealing thread pool (their lengths vary), and their outputs are handed back in order of
+// simulation number, so the files written are the same whatever the number of threads.
+class ReplicationRunner {
+public:
+	// Constructor. A number of threads of 0 means one thread per core.
+	explicit ReplicationRunner(unsigned numThreads = 0);
+
+	// Run replications first, first + 1, ..., first + count - 1. The consumer is called on the
+	// calling thread, in order of replication, as soon as each output (and all before it) is ready.
+	// With a warm start, every replication is forked from that snapshot instead of starting empty.
+	void run(const ModelParameters &, const SimulationOptions &, int first, int count, const ReplicationConsumer &,
+		const Snapshot *warmStart = 0);
+
+	// Run replications 0, 1, 2, ... until the replications so far satisfy the stopping rule (or its maximum
+	// number of replications is reached), and return the number of replications used. The minimum and maximum
+	// of the rule count replications, also with antithetic pairs. The statistics of the
+	// replications are accumulated in 'statistics'. Replications are launched in batches so that all threads
+	// stay busy; outputs after the stopping point are discarded, so the number of replications and the files
+	// written do not depend on the number of threads.
+	int runSequential(const ModelParameters &, const SimulationOptions &, const StoppingRule &,
+		ReplicationStatistics &statistics, const ReplicationConsumer &, const Snapshot *warmStart = 0);
+
+	// Run replications 0, ..., numSimulations - 1 of every scenario. All (scenario, replication) pairs are
+	// dispatched to the pool at once, so small scenarios do not leave threads idle. The consumer is called
+	// on the calling thread, in order of scenario and then of replication.
+	void runScenarios(const std::vector<ModelParameters> &, const SimulationOptions &, const ScenarioConsumer &);
+
+	// Run replications first[s], ..., first[s] + count[s] - 1 of every scenario s, in the same way
+	void runScenarios(const std::vector<ModelParameters> &, const std::vector<int> &first, const std::vector<int> &count,
+		const SimulationOptions &, const ScenarioConsumer &);
+
+	unsigned numThreads() const { return pool.size(); }
+
+	// Take the outputs of the simulations found in a results cache instead of running them, and store the
+	// outputs of those that are run (0 for no cache). The cache is only used with TRACE_NONE, without
+	// instrumentation and without a warm start, since it keeps neither the trace nor the console output.
+	// The outputs consumed are the same with and without the cache.
+	void setCache(ResultsCache *resultsCache) { cache = resultsCache; }
+
+private:
+	// Run 'count' jobs on the pool, at most 'maxRunning' at once, and consume their outputs in order of job
+	void runJobs(int count, int maxRunning, const std::function<ReplicationOutput(int)> &job,
+		const std::function<void(int, ReplicationOutput &)> &consume);
+
+	// Number of jobs run at once when each one keeps several threads busy (a simulation split over logical
+	// processes), so that the threads of all jobs together do not outnumber the cores
+	int jobsAtOnce(int threadsPerJob) const;
+
+	// Whether the results cache is used for simulations run with these options
+	bool usesCache(const SimulationOptions &) const;
+
+	ThreadPool pool;
+	ResultsCache *cache;
+};
+
+#endif /* REPLICATION_RUNNER_H */
@@ -0,0 +1,407 @@
+// Definition of class ResultsCache.
+
+#include <cstring> // std::memcpy, std::memcmp, std::memset
+
+// Include header file for class ResultsCache
+#include "ResultsCache.h"
+#include "PlantModel.h"
+
+// Version of the engine. Increase it when a change of the engine or of the statistics changes the results
+// of the simulations, so that results cached by older versions are not used.
+static const std::uint32_t engineVersion = 2;
+
+// Layout of a cache file: a ResultsCacheHeader, then the records. A record is its key (64 bits), the size
+// of its results in bytes (32 bits), a checksum of the results (32 bits), then the results: the fields of
+// the ReplicationResult in order and the number of events. A vector is its number of elements (64 bits)
+// followed by its elements.
+struct ResultsCacheHeader {
+	char magic[8];               // "DESCACHE"
+	std::uint32_t version;
+	std::uint32_t byteOrderMark; // 0x01020304 in the byte order of the machine that wrote the file
+};
+
+static const std::uint32_t cacheFileVersion = 1;
+static const std::uint32_t cacheByteOrderMark = 0x01020304;
+
+// Size of the key, size and checksum of a record
+static const std::size_t recordHeaderSize = 16;
+
+/* Keys */
+
+static void addDistribution(Fnv1aHash &hash, const Distribution &distribution)
+{
+	hash.addValue(static_cast<std::int32_t>(distribution.type));
+	hash.addValue(distribution.mean);
+	hash.addValue(distribution.stdev);
+	hash.addValue(distribution.minimum);
+}
+
+static void addRoutes(Fnv1aHash &hash, const std::vector<Route> &routes)
+{
+	hash.addValue(static_cast<std::uint64_t>(routes.size()));
+	for (std::size_t r = 0; r < routes.size(); ++r) {
+		hash.addValue(static_cast<std::int32_t>(routes[r].destination));
+		hash.addValue(routes[r].probability);
+	}
+}
+
+// Key of the simulations of a scenario: the engine version, the model inputs and the plant model
+std::uint64_t ResultsCache::scenarioKey(const ModelParameters &params)
+{
+	Fnv1aHash hash;
+	hash.addValue(engineVersion);
+
+	// The number of simulations does not change the results of each one. The master seed is added as an
+	// integer, since it may not fit in a double.
+	std::vector<std::string> names = parameterNames();
+	for (std::size_t i = 0; i < names.size(); ++i) {
+		double value = 0;
+		if (names[i] == "numSimulations" || !getParameter(params, names[i], value))
+			continue;
+		hash.addString(names[i]);
+		hash.addValue(value);
+	}
+	hash.addValue(static_cast<std::uint64_t>(params.masterSeed));
+
+	PlantModel model = buildPlantModel(params);
+	hash.addValue(static_cast<std::uint64_t>(model.parts.size()));
+	for (std::size_t p = 0; p < model.parts.size(); ++p) {
+		const PartType &part = model.parts[p];
+		hash.addString(part.name);
+		addDistribution(hash, part.interArrival);
+		hash.addValue(part.acceptProbability);
+		hash.addValue(static_cast<std::int32_t>(part.kitQuantity));
+		hash.addValue(static_cast<std::int32_t>(part.arrivalStream));
+		hash.addValue(static_cast<std::int32_t>(part.inspectionStream));
+		hash.addValue(static_cast<std::uint64_t>(part.arrivalTrace ? part.arrivalTrace->contentHash() : 0));
+	}
+	hash.addValue(static_cast<std::uint64_t>(model.stations.size()));
+	for (std::size_t s = 0; s < model.stations.size(); ++s) {
+		const Station &station = model.stations[s];
+		hash.addString(station.name);
+		addDistribution(hash, station.service);
+		hash.addValue(static_cast<std::int32_t>(station.servers));
+		hash.addValue(static_cast<std::int32_t>(station.rework ? 1 : 0));
+		addRoutes(hash, station.routes);
+		addRoutes(hash, station.reworkedRoutes);
+		hash.addValue(static_cast<std::int32_t>(station.serviceStream));
+		hash.addValue(static_cast<std::int32_t>(station.routingStream));
+		hash.addValue(static_cast<std::int32_t>(station.failures ? 1 : 0));
+		addDistribution(hash, station.timeToFailure);
+		addDistribution(hash, station.repairTime);
+		hash.addValue(station.shiftOn);
+		hash.addValue(station.shiftOff);
+		hash.addValue(static_cast<std::int32_t>(station.failureStream));
+		hash.addValue(static_cast<std::int32_t>(station.repairStream));
+	}
+	hash.addValue(static_cast<std::int32_t>(model.kitStation));
+	hash.addValue(static_cast<std::int32_t>(model.assemblyStation));
+	hash.addValue(static_cast<std::int32_t>(model.reworkStation));
+	hash.addValue(static_cast<std::int32_t>(model.numStreams));
+
+	return hash.value();
+}
+
+// Key of a simulation of a scenario
+std::uint64_t ResultsCache::replicationKey(std::uint64_t scenario, int replication)
+{
+	Fnv1aHash hash;
+	hash.addValue(scenario);
+	hash.addValue(static_cast<std::int32_t>(replication));
+	return hash.value();
+}
+
+/* Records */
+
+// Append raw bytes
+static void put(std::vector<char> &bytes, const void *data, std::size_t size)
+{
+	const char *begin = static_cast<const char *>(data);
+	bytes.insert(bytes.end(), begin, begin + size);
+}
+
+template <class T>
+static void putValue(std::vector<char> &bytes, const T &value)
+{
+	put(bytes, &value, sizeof(value));
+}
+
+static void putVector(std::vector<char> &bytes, const std::vector<double> &values)
+{
+	putValue(bytes, static_cast<std::uint64_t>(values.size()));
+	if (!values.empty())
+		put(bytes, &values[0], values.size() * sizeof(double));
+}
+
+// A distribution is written as its saved state
+static void putSketch(std::vector<char> &bytes, const QuantileSketch &sketch)
+{
+	std::vector<double> state;
+	sketch.save(state);
+	putVector(bytes, state);
+}
+
+// Reads raw bytes in order from part of a buffer. Reading past the end sets 'failed' and leaves the values untouched.
+class RecordReader {
+public:
+	RecordReader(const char *data, std::size_t size) : bytes(data), length(size), position(0), failed(false) {}
+
+	template <class T>
+	void getValue(T &value)
+	{
+		if (failed || sizeof(T) > length - position) {
+			failed = true;
+			return;
+		}
+		std::memcpy(&value, bytes + position, sizeof(T));
+		position += sizeof(T);
+	}
+
+	void getVector(std::vector<double> &values)
+	{
+		std::uint64_t size = 0;
+		getValue(size);
+		if (failed || size > (length - position) / sizeof(double)) {
+			failed = true;
+			return;
+		}
+		values.resize(static_cast<std::size_t>(size));
+		if (size > 0)
+			std::memcpy(&values[0], bytes + position, values.size() * sizeof(double));
+		position += values.size() * sizeof(double);
+	}
+
+	void getSketch(QuantileSketch &sketch)
+	{
+		std::vector<double> state;
+		getVector(state);
+		if (failed || state.size() < 6 || !(state[0] > 0) || state[5] != state.size() - 6) {
+			failed = true;
+			return;
+		}
+		sketch.restore(state, 0);
+	}
+
+	bool ok() const { return !failed; }
+	bool atEnd() const { return position == length; }
+
+private:
+	const char *bytes;
+	std::size_t length;
+	std::size_t position;
+	bool failed;
+};
+
+// Checksum of the results of a record
+static std::uint32_t checksum(const char *data, std::size_t size)
+{
+	Fnv1aHash hash;
+	hash.add(data, size);
+	return static_cast<std::uint32_t>(hash.value() ^ (hash.value() >> 32));
+}
+
+// Convert the output of a simulation to the results of a record
+static void serializeOutput(const ReplicationOutput &output, std::vector<char> &bytes)
+{
+	const ReplicationResult &result = output.result;
+
+	bytes.clear();
+	putValue(bytes, static_cast<std::int32_t>(result.simulationNumber));
+	putValue(bytes, result.totalAssembliesCreated);
+	putValue(bytes, result.totalAssembliesDelivered);
+	putValue(bytes, result.averageTimeInSystem);
+	putValue(bytes, result.averageNumInSystem);
+	putValue(bytes, result.propAssemblyBusy);
+	putValue(bytes, result.propReWorkBusy);
+	putValue(bytes, result.warmUpTime);
+	putVector(bytes, result.stationUtilization);
+	putVector(bytes, result.serverUtilization);
+
+	putValue(bytes, result.batchMeans.batchWidth);
+	putValue(bytes, static_cast<std::uint64_t>(result.batchMeans.means.size()));
+	for (std::size_t m = 0; m < result.batchMeans.means.size(); ++m)
+		putVector(bytes, result.batchMeans.means[m]);
+
+	putValue(bytes, static_cast<std::uint64_t>(output.numEvents));
+
+	putSketch(bytes, result.timeInSystemDistribution);
+	putSketch(bytes, result.reworkDistribution);
+	putValue(bytes, static_cast<std::uint64_t>(result.waitingTimeDistribution.size()));
+	for (std::size_t s = 0; s < result.waitingTimeDistribution.size(); ++s)
+		putSketch(bytes, result.waitingTimeDistribution[s]);
+}
+
+// Convert the results of a record back to the output of a simulation
+static bool deserializeOutput(const std::vector<char> &bytes, ReplicationOutput &output)
+{
+	RecordReader reader(bytes.empty() ? 0 : &bytes[0], bytes.size());
+	ReplicationResult &result = output.result;
+
+	std::int32_t simulationNumber = 0;
+	std::uint64_t numStatistics = 0, numEvents = 0, numStations = 0;
+
+	reader.getValue(simulationNumber);
+	reader.getValue(result.totalAssembliesCreated);
+	reader.getValue(result.totalAssembliesDelivered);
+	reader.getValue(result.averageTimeInSystem);
+	reader.getValue(result.averageNumInSystem);
+	reader.getValue(result.propAssemblyBusy);
+	reader.getValue(result.propReWorkBusy);
+	reader.getValue(result.warmUpTime);
+	reader.getVector(result.stationUtilization);
+	reader.getVector(result.serverUtilization);
+
+	reader.getValue(result.batchMeans.batchWidth);
+	reader.getValue(numStatistics);
+	if (reader.ok() && numStatistics <= bytes.size()) {
+		result.batchMeans.means.resize(static_cast<std::size_t>(numStatistics));
+		for (std::size_t m = 0; m < result.batchMeans.means.size(); ++m)
+			reader.getVector(result.batchMeans.means[m]);
+	}
+
+	reader.getValue(numEvents);
+
+	reader.getSketch(result.timeInSystemDistribution);
+	reader.getSketch(result.reworkDistribution);
+	reader.getValue(numStations);
+	if (reader.ok() && numStations <= bytes.size()) {
+		result.waitingTimeDistribution.resize(static_cast<std::size_t>(numStations));
+		for (std::size_t s = 0; s < result.waitingTimeDistribution.size(); ++s)
+			reader.getSketch(result.waitingTimeDistribution[s]);
+	}
+
+	if (!reader.ok() || !reader.atEnd() || numStatistics > bytes.size() || numStations > bytes.size())
+		return false;
+
+	result.simulationNumber = simulationNumber;
+	output.numEvents = numEvents;
+	output.eventTrace.clear();
+	output.consoleOutput.clear();
+	output.instrumentation = InstrumentationData();
+	return true;
+}
+
+/* The cache */
+
+// Constructor
+ResultsCache::ResultsCache() : file(0) {}
+
+// Destructor
+ResultsCache::~ResultsCache()
+{
+	if (file)
+		std::fclose(file);
+}
+
+// Read the records of a cache file and open it to append new ones
+bool ResultsCache::open(const std::string &path, std::string &error)
+{
+	if (file) {
+		std::fclose(file);
+		file = 0;
+	}
+	records.clear();
+
+	// Read the whole file, if there is one
+	std::vector<char> bytes;
+	std::FILE *input = std::fopen(path.c_str(), "rb");
+	if (input) {
+		char buffer[65536];
+		std::size_t count;
+		while ((count = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+			bytes.insert(bytes.end(), buffer, buffer + count);
+		std::fclose(input);
+	}
+
+	ResultsCacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DESCACHE", 8);
+	header.version = cacheFileVersion;
+	header.byteOrderMark = cacheByteOrderMark;
+
+	// Keep the records up to the first one that is incomplete or damaged
+	std::size_t validSize = 0;
+	if (!bytes.empty()) {
+		if (bytes.size() < sizeof(header) || std::memcmp(&bytes[0], "DESCACHE", 8) != 0) {
+			error = path + " is not a results cache";
+			return false;
+		}
+		if (std::memcmp(&bytes[0], &header, sizeof(header)) != 0) {
+			error = path + " was written by another version of the program or on another kind of machine";
+			return false;
+		}
+
+		std::size_t position = sizeof(header);
+		while (bytes.size() - position >= recordHeaderSize) {
+			std::uint64_t key;
+			std::uint32_t size, sum;
+			std::memcpy(&key, &bytes[position], 8);
+			std::memcpy(&size, &bytes[position + 8], 4);
+			std::memcpy(&sum, &bytes[position + 12], 4);
+			if (size > bytes.size() - position - recordHeaderSize)
+				break;
+
+			const char *data = &bytes[position + recordHeaderSize];
+			if (checksum(data, size) != sum)
+				break;
+
+			records[key].assign(data, data + size);
+			position += recordHeaderSize + size;
+		}
+		validSize = position;
+	}
+
+	// Write the file again without what follows the last complete record, or write its header if it is new
+	if (validSize != bytes.size() || bytes.empty()) {
+		std::FILE *output = std::fopen(path.c_str(), "wb");
+		if (!output) {
+			error = "cannot create " + path;
+			return false;
+		}
+
+		bool written;
+		if (bytes.empty())
+			written = std::fwrite(&header, sizeof(header), 1, output) == 1;
+		else
+			written = std::fwrite(&bytes[0], 1, validSize, output) == validSize;
+		if (std::fclose(output) != 0)
+			written = false;
+
+		if (!written) {
+			error = "cannot write " + path;
+			return false;
+		}
+	}
+
+	file = std::fopen(path.c_str(), "ab");
+	if (!file) {
+		error = "cannot write " + path;
+		return false;
+	}
+
+	return true;
+}
+
+// Get the output of a simulation from the cache
+bool ResultsCache::find(std::uint64_t key, ReplicationOutput &output) const
+{
+	std::unordered_map<std::uint64_t, std::vector<char> >::const_iterator record = records.find(key);
+	return record != records.end() && deserializeOutput(record->second, output);
+}
+
+// Add the output of a simulation to the cache
+bool ResultsCache::store(std::uint64_t key, const ReplicationOutput &output)
+{
+	std::vector<char> &bytes = records[key];
+	serializeOutput(output, bytes);
+
+	if (!file)
+		return false;
+
+	// The record is flushed at once, so that it survives an interruption of the program
+	std::uint32_t size = static_cast<std::uint32_t>(bytes.size());
+	std::uint32_t sum = checksum(&bytes[0], bytes.size());
+	bool written = std::fwrite(&key, 8, 1, file) == 1 && std::fwrite(&size, 4, 1, file) == 1 &&
+		std::fwrite(&sum, 4, 1, file) == 1 && std::fwrite(&bytes[0], 1, bytes.size(), file) == bytes.size();
+	return std::fflush(file) == 0 && written;
+}
@@ -0,0 +1,87 @@
+// Header file for class ResultsCache
+#ifndef RESULTS_CACHE_H
+#define RESULTS_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "ModelParameters.h"
+#include "Simulation.h"
+
+// 64-bit FNV-1a hash of a sequence of bytes
+class Fnv1aHash {
+public:
+	Fnv1aHash() : hash(14695981039346656037ULL) {}
+
+	void add(const void *data, std::size_t size)
+	{
+		const unsigned char *bytes = static_cast<const unsigned char *>(data);
+		for (std::size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	template <class T>
+	void addValue(const T &value) { add(&value, sizeof(value)); }
+
+	void addString(const std::string &text)
+	{
+		addValue(static_cast<std::uint64_t>(text.size()));
+		add(text.data(), text.size());
+	}
+
+	std::uint64_t value() const { return hash; }
+
+private:
+	std::uint64_t hash;
+};
+
+// Results of simulations kept on disk, so that a simulation that was already run is not run again: by the
+// next run of a sweep after a change of some of its scenarios, or after an interruption.
+//
+// A simulation is identified by a key, the hash of everything its results depend on: the version of the
+// engine, all model inputs (see parameterNames), the plant model simulated (with the contents of its
+// arrival traces), and its simulation number, which selects its random number streams. Options that do
+// not change the results (FEL backend, threads, logical processes) are not part of the key.
+//
+// The file is a log: a header, then one record per simulation appended as soon as it is stored, with
+// the key, the size and a checksum of the results. Records cut short by an interruption are dropped when
+// the file is opened. Only the statistics of interest, their distributions and the number of events are kept,
+// so the cache is only used for simulations run without a trace (see ReplicationRunner::setCache).
+class ResultsCache {
+public:
+	ResultsCache();
+	~ResultsCache();
+
+	// Read the records of a cache file, creating it if there is none, and keep it open to append new records.
+	// Returns false with a message if the file cannot be read or written, or is not a cache file.
+	bool open(const std::string &path, std::string &error);
+
+	bool isOpen() const { return file != 0; }
+
+	// Number of simulations in the cache
+	std::size_t size() const { return records.size(); }
+
+	// Key of the simulations of a scenario, and of simulation number 'replication' (starting at 0) of a scenario
+	static std::uint64_t scenarioKey(const ModelParameters &);
+	static std::uint64_t replicationKey(std::uint64_t scenario, int replication);
+
+	// Get the output of a simulation (without trace or console output). Returns false if it is not in the cache.
+	bool find(std::uint64_t key, ReplicationOutput &) const;
+
+	// Add the output of a simulation and append it to the file. Returns false if it cannot be written.
+	bool store(std::uint64_t key, const ReplicationOutput &);
+
+private:
+	ResultsCache(const ResultsCache &);
+	ResultsCache &operator=(const ResultsCache &);
+
+	std::FILE *file;
+	std::unordered_map<std::uint64_t, std::vector<char> > records; // Results of each key, as written in the file
+};
+
+#endif /* RESULTS_CACHE_H */
@@ -0,0 +1,155 @@
+// Definition of class Simulation.
+
+// Include header file for class Simulation
+#include "Simulation.h"
+
+// Include the engine and its policies
+#include "SimulationEngine.h"
+#include "ParallelEngine.h"
+#include "BinaryTrace.h"
+
+// Include the key of the model inputs of a snapshot
+#include "ResultsCache.h"
+
+// Run one simulation with a particular instantiation of the engine, from the empty system or from a snapshot
+template <class FEL, class Trace, class Stats>
+static ReplicationOutput runEngine(const PlantModel &model, const ModelParameters &params, const Trace &trace, int replication,
+	const Snapshot *snapshot, SnapshotMode mode)
+{
+	SimulationEngine<FEL, BufferedRandomStreams, Trace, Stats> engine(model, params, trace);
+	if (snapshot)
+		return engine.runFromSnapshot(*snapshot, replication, mode);
+	return engine.run(replication);
+}
+
+// Pick the statistics policy for the warm-up method of the model, or for batch means
+template <class FEL, class Trace>
+static ReplicationOutput runEngine(const PlantModel &model, const ModelParameters &params, const Trace &trace, int replication,
+	const Snapshot *snapshot, SnapshotMode mode)
+{
+	if (params.batchMeans)
+		return runEngine<FEL, Trace, BatchMeansStatistics>(model, params, trace, replication, snapshot, mode);
+	if (params.warmUpMethod == WARMUP_MSER5)
+		return runEngine<FEL, Trace, MSERStatistics>(model, params, trace, replication, snapshot, mode);
+
+	return runEngine<FEL, Trace, SteadyStateStatistics>(model, params, trace, replication, snapshot, mode);
+}
+
+// Number of logical processes that a simulation from the empty system is split over (1 if it is not)
+static int logicalProcessesOf(const PlantModel &model, const ModelParameters &params, const SimulationOptions &options)
+{
+	if (options.logicalProcesses > 1 && options.traceLevel == TRACE_NONE && !params.batchMeans &&
+		params.warmUpMethod == WARMUP_FIXED && !model.hasArrivalTraces() && !model.hasDowntime())
+		return logicalProcessesFor(model, options.logicalProcesses);
+	return 1;
+}
+
+// Pick the trace policy for a FEL backend
+template <class FEL>
+static ReplicationOutput runWithFEL(const PlantModel &model, const ModelParameters &params, const SimulationOptions &options, int replication,
+	const Snapshot *snapshot, SnapshotMode mode)
+{
+	// Split the simulation over logical processes if it can be
+	if (!snapshot && logicalProcessesOf(model, params, options) > 1) {
+		ParallelSimulationEngine<FEL> engine(model, params, options.logicalProcesses);
+		return engine.run(replication);
+	}
+
+	switch (options.traceLevel) {
+	case TRACE_NONE:
+		return runEngine<FEL>(model, params, NoTrace(), replication, snapshot, mode);
+	case TRACE_SUMMARY:
+		return runEngine<FEL>(model, params, SummaryTrace(), replication, snapshot, mode);
+	case TRACE_BINARY:
+		return runEngine<FEL>(model, params, BinaryTrace(options.binaryTrace), replication, snapshot, mode);
+	case TRACE_FULL:
+		break;
+	}
+
+	return runEngine<FEL>(model, params, FullTrace(), replication, snapshot, mode);
+}
+
+// Run a simulation until a point in time and save its state, with the statistics policy of the warm-up method
+// or of batch means
+template <class FEL>
+static void snapshotWithFEL(const PlantModel &model, const ModelParameters &params, int replication, double time, Snapshot &snapshot)
+{
+	if (params.batchMeans) {
+		SimulationEngine<FEL, BufferedRandomStreams, NoTrace, BatchMeansStatistics> engine(model, params);
+		engine.runToSnapshot(replication, time, snapshot);
+	}
+	else if (params.warmUpMethod == WARMUP_MSER5) {
+		SimulationEngine<FEL, BufferedRandomStreams, NoTrace, MSERStatistics> engine(model, params);
+		engine.runToSnapshot(replication, time, snapshot);
+	}
+	else {
+		SimulationEngine<FEL, BufferedRandomStreams, NoTrace, SteadyStateStatistics> engine(model, params);
+		engine.runToSnapshot(replication, time, snapshot);
+	}
+}
+
+// Constructor. A model given in the parameters is shared rather than copied.
+Simulation::Simulation(const ModelParameters &parameters, const SimulationOptions &simulationOptions)
+	: params(parameters), options(simulationOptions), model(parameters.plantModel)
+{
+	if (!model)
+		model = std::make_shared<PlantModel>(referencePlant(params));
+}
+
+// Run a simulation from the empty system or from a snapshot with the FEL backend and trace level
+// selected by the options
+static ReplicationOutput runSimulation(const PlantModel &model, const ModelParameters &params, const SimulationOptions &options,
+	int replication, const Snapshot *snapshot, SnapshotMode mode)
+{
+	switch (options.felType) {
+	case FEL_BINARY_HEAP:
+		return runWithFEL<BinaryHeapFEL>(model, params, options, replication, snapshot, mode);
+	case FEL_PAIRING_HEAP:
+		return runWithFEL<PairingHeapFEL>(model, params, options, replication, snapshot, mode);
+	case FEL_CALENDAR_QUEUE:
+		return runWithFEL<CalendarQueueFEL>(model, params, options, replication, snapshot, mode);
+	case FEL_QUATERNARY_HEAP:
+		break;
+	}
+
+	return runWithFEL<QuaternaryHeapFEL>(model, params, options, replication, snapshot, mode);
+}
+
+// Run simulation number 'replication' (starting at 0)
+ReplicationOutput Simulation::run(int replication)
+{
+	return runSimulation(*model, params, options, replication, 0, SNAPSHOT_FORK);
+}
+
+// Run simulation number 'replication' from a snapshot
+ReplicationOutput Simulation::run(int replication, const Snapshot &snapshot, SnapshotMode mode)
+{
+	return runSimulation(*model, params, options, replication, &snapshot, mode);
+}
+
+// Run simulation number 'replication' until 'time' and save its state, with the key of its inputs
+void Simulation::snapshot(int replication, double time, Snapshot &snapshot)
+{
+	switch (options.felType) {
+	case FEL_BINARY_HEAP:
+		snapshotWithFEL<BinaryHeapFEL>(*model, params, replication, time, snapshot);
+		break;
+	case FEL_PAIRING_HEAP:
+		snapshotWithFEL<PairingHeapFEL>(*model, params, replication, time, snapshot);
+		break;
+	case FEL_CALENDAR_QUEUE:
+		snapshotWithFEL<CalendarQueueFEL>(*model, params, replication, time, snapshot);
+		break;
+	default:
+		snapshotWithFEL<QuaternaryHeapFEL>(*model, params, replication, time, snapshot);
+		break;
+	}
+
+	snapshot.scenarioKey = ResultsCache::scenarioKey(params);
+}
+
+// Number of logical processes of each simulation
+int Simulation::logicalProcesses() const
+{
+	return logicalProcessesOf(*model, params, options);
+}
@@ -0,0 +1,131 @@
+// Header file for class Simulation
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "FutureEventList.h"
+#include "Instrumentation.h"
+#include "ModelParameters.h"
+#include "PlantModel.h"
+#include "QuantileSketch.h"
+#include "Snapshot.h"
+
+// How much a simulation writes while it runs (see TracePolicies.h)
+enum TraceLevel {
+	TRACE_NONE,    // Nothing: only the statistics of interest are returned
+	TRACE_SUMMARY, // The final state of each simulation is written to Simulation_Runs.csv
+	TRACE_FULL,    // One row per event in Simulation_Runs.csv, and the FEL printed after every event
+	TRACE_BINARY   // One binary record per event, written to a BinaryTraceFile by a background thread
+};
+
+class BinaryTraceFile;
+
+// Options that do not change the results of a simulation, only how it is run and what it writes
+struct SimulationOptions {
+	SimulationOptions() : felType(FEL_QUATERNARY_HEAP), traceLevel(TRACE_FULL), binaryTrace(0), logicalProcesses(0) {}
+
+	// Backend used to hold the Future Event List (FEL). See FutureEventList.h for the options.
+	FELType felType;
+
+	// What is written while the simulation runs
+	TraceLevel traceLevel;
+
+	// File that receives the records when the trace level is TRACE_BINARY (see BinaryTrace.h)
+	BinaryTraceFile *binaryTrace;
+
+	// Number of logical processes (threads) that share each simulation, see ParallelEngine.h. 0 or 1 runs each
+	// simulation on one thread. Only used with TRACE_NONE, the fixed warm-up and no batch means, from the empty
+	// system, without arrival traces or station downtime; the simulation runs on one thread anyway if the model
+	// cannot be split (a station whose service time can be 0: give it a 'min', see line_plant.txt). The reference
+	// plant (reference_plant.txt, and the plant built from the inputs) has no such minimum, so it always runs on
+	// one thread: logicalProcesses() is 1, and only plants like line_plant.txt (as in Benchmark) are split.
+	int logicalProcesses;
+
+};
+
+// Define state of system
+struct state_t {
+	int numAssembly; // Total number of Assemblies in the entire system
+	std::vector<int> numAtStation; // Number of Assemblies either in each station or in its queue
+	std::vector<int> numParts; // Number of accepted parts of each type waiting to be kitted into an Assembly
+};
+
+// Batch means of one simulation (see BatchMeansStatistics): the mean of each statistic in each complete batch
+// after the warm-up, in time order. The statistics are the time in system per delivered assembly, the number
+// of assemblies in the system, then the utilization of each station.
+struct BatchMeansSeries {
+	BatchMeansSeries() : batchWidth(0) {}
+
+	double batchWidth;                       // Width of the batches (mins)
+	std::vector<std::vector<double> > means; // means[statistic][batch]. NaN for a batch without deliveries.
+};
+
+// Statistics of interest at the end of one simulation (one row of Simulation_Results.csv)
+struct ReplicationResult {
+	int simulationNumber; // Starting at 1
+
+	double totalAssembliesCreated;
+	double totalAssembliesDelivered;
+	double averageTimeInSystem;
+	double averageNumInSystem;
+	double propAssemblyBusy;
+	double propReWorkBusy;
+
+	double warmUpTime; // Time after which the statistics of interest were recorded
+
+	std::vector<double> stationUtilization; // Proportion of time the servers of each station were busy
+	std::vector<double> serverUtilization;  // Proportion of time each server was busy (station by station)
+
+	BatchMeansSeries batchMeans; // Empty unless params.batchMeans
+
+	// Distributions of the observations after the warm-up, for their quantiles (see QuantileSketch.h). Empty
+	// with the MSER-5 warm-up, whose truncation point is only known at the end.
+	QuantileSketch timeInSystemDistribution;              // Time in system of each assembly delivered (mins)
+	QuantileSketch reworkDistribution;                    // Times each assembly delivered went through rework
+	std::vector<QuantileSketch> waitingTimeDistribution;  // Time in the queue of each station before service (mins)
+};
+
+// Everything produced by one simulation. The event trace and console output are kept in memory
+// so that simulations run in parallel can be written out in order.
+struct ReplicationOutput {
+	ReplicationResult result;
+	std::string eventTrace;    // Rows for Simulation_Runs.csv
+	std::string consoleOutput; // Text for the command window
+	unsigned long long numEvents; // Number of events executed (including the end of simulation)
+	InstrumentationData instrumentation; // Measurements of the event loop (empty unless SIM_ENABLE_INSTRUMENTATION)
+};
+
+// Runs simulations of the plant with the engine selected by the options. The engine itself is the
+// class template SimulationEngine (SimulationEngine.h); this class picks the instantiation for the
+// FEL backend and trace level at run time. The plant is params.plantModel, or the reference plant
+// built from the parameters. Separate objects can run simulations at the same time on different threads.
+class Simulation {
+public:
+	Simulation(const ModelParameters &, const SimulationOptions &);
+
+	// Run simulation number 'replication' (starting at 0) and return what it produced
+	ReplicationOutput run(int replication);
+
+	// Run simulation number 'replication' until 'time' and save its state in 'snapshot', with the key of the
+	// model inputs (Snapshot::scenarioKey). Nothing is traced.
+	void snapshot(int replication, double time, Snapshot &snapshot);
+
+	// Run simulation number 'replication' from a snapshot until the end of simulation time (see SnapshotMode).
+	// The snapshot must fit the model, and to continue it, it must have the same warm-up method and batch means setting.
+	ReplicationOutput run(int replication, const Snapshot &, SnapshotMode);
+
+	// Number of logical processes (threads) that run(replication) splits a simulation from the empty system
+	// over: options.logicalProcesses if it can be split, otherwise 1
+	int logicalProcesses() const;
+
+
+private:
+	ModelParameters params;
+	SimulationOptions options;
+	std::shared_ptr<const PlantModel> model;
+};
+
+#endif /* SIMULATION_H */
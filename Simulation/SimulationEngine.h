@@ -0,0 +1,644 @@
+// Header file for class template SimulationEngine
+#ifndef SIMULATION_ENGINE_H
+#define SIMULATION_ENGINE_H
+
+#include <iostream>
+#include <vector>
+
+#include "Event.h"
+#include "EntityStore.h"
+#include "Instrumentation.h"
+#include "FutureEventList.h"
+#include "RandomStream.h"
+#include "ModelParameters.h"
+#include "PlantModel.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+#include "StationNetwork.h"
+#include "TracePolicies.h"
+#include "StatisticsPolicies.h"
+
+// One simulation of a manufacturing plant described by a PlantModel.
+//
+// Parts of each type arrive and are inspected separately, and either passed or rejected. Once
+// there is a kit of accepted parts (kitQuantity of each type), they are joined into an Assembly
+// entity, which goes through the network of stations: at each station it waits in a First In
+// First Out queue, is served, and follows one of the routes of the station, to another station
+// or out of the plant. In the reference plant (see referencePlant), 5 parts are joined, and an
+// assembly goes to the assembly station, then to the coating station, and finally to an
+// assembly-level inspection. Accepted parts leave the system. Rejected parts are sent to a re-work
+// station, and from then are sent to back to the assembly station.
+//
+// Every station is handled by the same event handlers over the contiguous arrays of station state
+// (see StationNetwork.h, shared with ParallelSimulationEngine), so a larger plant needs a new model
+// description but no new code. A station may have several servers in parallel: the idle servers of
+// each station are kept on a stack, so starting and ending a service are O(1) whatever the number of
+// servers.
+//
+// Stations with breakdowns or a shift calendar go down and up with events of their own. Going down
+// cancels the departures of the services under way through their FEL handles, and going up schedules
+// them again with the service time that was left.
+//
+// The engine is specialized at compile time by policies:
+//   FEL   - concrete Future Event List class (e.g. QuaternaryHeapFEL, see FutureEventList.h)
+//   RNG   - set of random number streams, indexed by stream number (RandomStreams or BufferedRandomStreams,
+//           see RandomStream.h), with state(id) and restore(id, stream) for snapshots
+//   Trace - what is written while the simulation runs (NoTrace, SummaryTrace or FullTrace, see TracePolicies.h)
+//   Stats - which statistics of interest are recorded (see StatisticsPolicies.h)
+// A production instantiation such as SimulationEngine<QuaternaryHeapFEL, BufferedRandomStreams, NoTrace,
+// SteadyStateStatistics> has no tracing code left in its event loop. Likewise, the instrumentation
+// (see Instrumentation.h) is only compiled in with SIM_ENABLE_INSTRUMENTATION.
+template <class FEL, class RNG, class Trace, class Stats>
+class SimulationEngine : private StationNetwork<SimulationEngine<FEL, RNG, Trace, Stats>, FEL, RNG, Stats> {
+public:
+	// Constructor. The model must outlive the engine. The trace policy is copied from 'tracePrototype'
+	// (e.g. to share an output file).
+	SimulationEngine(const PlantModel &, const ModelParameters &, const Trace &tracePrototype = Trace());
+
+	// Run simulation number 'replication' (starting at 0) and return what it produced
+	ReplicationOutput run(int replication);
+
+	// Run simulation number 'replication' from the empty system until the first event at or after 'time',
+	// and save its state at 'time' in 'snapshot'. The end of simulation time is not used. Events go to the trace
+	// policy as usual, but its output is dropped, so this is meant for an engine with NoTrace.
+	void runToSnapshot(int replication, double time, Snapshot &snapshot);
+
+	// Run simulation number 'replication' from a snapshot taken by runToSnapshot until the end of simulation
+	// time, and return what it produced. See SnapshotMode for the difference between continuing and forking.
+	ReplicationOutput runFromSnapshot(const Snapshot &, int replication, SnapshotMode);
+
+private:
+	typedef StationNetwork<SimulationEngine, FEL, RNG, Stats> Network;
+	friend class StationNetwork<SimulationEngine, FEL, RNG, Stats>;
+
+	// The state of the stations and the handlers that move the entities through them
+	using Network::model;
+	using Network::listOfEvents;
+	using Network::randomStreams;
+	using Network::stats;
+	using Network::instrumentation;
+	using Network::simulationTime;
+	using Network::entities;
+	using Network::stationQueues;
+	using Network::busyServers;
+	using Network::firstServer;
+	using Network::idleServers;
+	using Network::services;
+	using Network::stationDown;
+	using Network::systemState;
+	using Network::arrivalTraces;
+	using Network::createAssemblyEntities;
+	using Network::arriveAtStation;
+	using Network::startService;
+	using Network::arrival;
+	using Network::departure;
+	using Network::scheduleArrival;
+	typedef typename Network::Service Service;
+
+	// An entity that leaves a station arrives at the next station of its route at once
+	void sendTo(int station, EntityHandle ID) { arriveAtStation(station, ID); }
+
+	// Reset list of Events, simulation time, statistics of interest, state of the system
+	// and random number streams before a new simulation run.
+	void resetAll(int replication);
+
+	// Schedule the first arrival of every part type, the first breakdown and end of shift of every station that
+	// has them, and the end of simulation if 'withEnd' is true
+	void scheduleFirstEvents(bool withEnd);
+
+	// Execute events until the end of simulation event (returns true), or until the next event is at or
+	// after 'until' (returns false). 'nextEvent' is the last event executed, or in the second case the next
+	// event, which has been taken out of the FEL but not executed.
+	bool executeEvents(double until, Event &nextEvent);
+
+	// End the trace of simulation number 'replication' after its last event, and return what it produced
+	ReplicationOutput finish(int replication, const Event &lastEvent);
+
+	// Save the state of the simulation in a snapshot, with 'nextEvent' (taken out of the FEL) as its next event
+	void saveSnapshot(const Event &nextEvent, Snapshot &) const;
+
+	// Restore the state of the simulation from a snapshot, for simulation number 'replication'
+	void restoreSnapshot(const Snapshot &, int replication, SnapshotMode);
+
+	// Prints list of Events to the console output
+	void printListOfEvents(std::ostream &) const;
+
+	// State of the system and statistics of interest after an event, for the event trace. 'partSerial'
+	// is the serial number of the Assembly entity of the event (0 if none), and 'location' its part
+	// type or station.
+	TraceRow makeTraceRow(const Event &, EntityHandle partSerial, int location) const;
+
+	// An event handler: a member function that handles changes in the system state when an event occurs
+	typedef void (SimulationEngine::*EventHandler)(const Event &);
+
+	// Register the handler of an event type. A new kind of event only needs a new EventType and
+	// a call to this function in the constructor.
+	void registerHandler(EventType type, EventHandler handler) { handlers[type] = handler; }
+
+	// To handle changes in the system state when an event occurs (besides those of StationNetwork)
+	void failure(const Event &);
+	void repair(const Event &);
+	void shiftEnd(const Event &);
+	void shiftStart(const Event &);
+
+	// A station goes down (for a breakdown or the end of its shift) or comes back up. It works again once
+	// every reason for being down is over.
+	void stopStation(int station);
+	void restartStation(int station);
+
+	void endOfSimulation(const Event &);
+	void unknownEvent(const Event &);
+
+	ModelParameters params;
+
+	Trace trace;
+
+	// Declare the event handlers, indexed by event type
+	EventHandler handlers[NUM_EVENT_TYPES];
+
+	// Set by the handler of the end of simulation event
+	bool simulationOver;
+
+	// Number of events executed so far
+	unsigned long long numEvents;
+};
+
+// Constructor
+template <class FEL, class RNG, class Trace, class Stats>
+SimulationEngine<FEL, RNG, Trace, Stats>::SimulationEngine(const PlantModel &plantModel, const ModelParameters &parameters, const Trace &tracePrototype)
+	: Network(plantModel), params(parameters), trace(tracePrototype)
+{
+	for (int type = 0; type < NUM_EVENT_TYPES; ++type)
+		handlers[type] = &SimulationEngine::unknownEvent;
+
+	registerHandler(EVENT_ARRIVAL, &SimulationEngine::arrival);
+	registerHandler(EVENT_DEPARTURE, &SimulationEngine::departure);
+	registerHandler(EVENT_END, &SimulationEngine::endOfSimulation);
+	registerHandler(EVENT_FAILURE, &SimulationEngine::failure);
+	registerHandler(EVENT_REPAIR, &SimulationEngine::repair);
+	registerHandler(EVENT_SHIFT_END, &SimulationEngine::shiftEnd);
+	registerHandler(EVENT_SHIFT_START, &SimulationEngine::shiftStart);
+
+	resetAll(0);
+}
+
+// Run simulation number 'replication' (starting at 0) and return what it produced
+template <class FEL, class RNG, class Trace, class Stats>
+ReplicationOutput SimulationEngine<FEL, RNG, Trace, Stats>::run(int replication)
+{
+	// Reset list of Events, simulation time, statistics of interest, state of the system
+	// and random number streams before a new simulation run.
+	resetAll(replication);
+	trace.beginReplication(replication, model);
+	if (Instrumentation::enabled)
+		instrumentation.begin(model.stations.size());
+
+	// Schedule end of simulation event and the first arrivals (order of insertion into list does not matter)
+	scheduleFirstEvents(true);
+
+	//Finally, initialize a placeholder Event variable for use in simulation
+	Event nextEvent = Event();
+
+	executeEvents(HUGE_VAL, nextEvent);
+
+	return finish(replication, nextEvent);
+}
+
+// Run a simulation until a point in time and save its state
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::runToSnapshot(int replication, double time, Snapshot &snapshot)
+{
+	resetAll(replication);
+	trace.beginReplication(replication, model);
+	if (Instrumentation::enabled)
+		instrumentation.begin(model.stations.size());
+
+	// Without the end of simulation event, the simulation stops at the first event at or after 'time'
+	scheduleFirstEvents(false);
+
+	Event nextEvent = Event();
+	executeEvents(time, nextEvent);
+
+	// Nothing happens until the next event, so this is also the state at 'time'
+	simulationTime = time;
+	snapshot.replication = replication;
+	saveSnapshot(nextEvent, snapshot);
+}
+
+// Run a simulation from a snapshot until the end of simulation time
+template <class FEL, class RNG, class Trace, class Stats>
+ReplicationOutput SimulationEngine<FEL, RNG, Trace, Stats>::runFromSnapshot(const Snapshot &snapshot, int replication, SnapshotMode mode)
+{
+	restoreSnapshot(snapshot, replication, mode);
+	trace.beginReplication(replication, model);
+	if (Instrumentation::enabled)
+		instrumentation.begin(model.stations.size());
+
+	Event nextEvent = Event();
+	executeEvents(HUGE_VAL, nextEvent);
+
+	return finish(replication, nextEvent);
+}
+
+// Schedule the first events of a simulation
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::scheduleFirstEvents(bool withEnd)
+{
+	// Schedule end of simulation event
+	if (withEnd)
+		listOfEvents.insert(Event(EVENT_END, params.endSimulationTime));
+
+	// Schedule also the first arrival event of every part type
+	for (std::size_t p = 0; p < model.parts.size(); ++p)
+		scheduleArrival(static_cast<std::uint32_t>(p));
+
+	// and the first breakdown and end of shift of the stations that have them
+	for (std::size_t s = 0; s < model.stations.size(); ++s) {
+		const Station &station = model.stations[s];
+		std::uint32_t ID = static_cast<std::uint32_t>(s);
+		if (station.failures)
+			listOfEvents.insert(Event(EVENT_FAILURE, simulationTime + station.timeToFailure.sample(randomStreams[station.failureStream]), ID));
+		if (station.shiftOff > 0)
+			listOfEvents.insert(Event(EVENT_SHIFT_END, simulationTime + station.shiftOn, ID));
+	}
+}
+
+// Execute events until the end of the simulation or until a point in time
+template <class FEL, class RNG, class Trace, class Stats>
+bool SimulationEngine<FEL, RNG, Trace, Stats>::executeEvents(double until, Event &nextEvent)
+{
+	//////////////////////////////
+	// Begin actual simulation //
+	/////////////////////////////
+
+	// Loop through each event in the simulation until the end of the simulation is reached.
+	while (1) {
+
+		// Without the end of simulation event (to take a snapshot), the list of events runs empty once the
+		// arrival traces are exhausted and the last assemblies have left: nothing happens until 'until'
+		if (listOfEvents.empty()) {
+			nextEvent = Event();
+			return false;
+		}
+
+		// Get next event in list of events, and delete it from the list of events (!!)
+		if (Instrumentation::enabled)
+			instrumentation.beforeNextEvent(listOfEvents.size());
+		nextEvent = listOfEvents.popNext();
+		if (Instrumentation::enabled)
+			instrumentation.afterNextEvent();
+
+		// Stop before an event at or after 'until' (to take a snapshot)
+		if (nextEvent.getTimeOfEvent() >= until)
+			return false;
+
+		numEvents++;
+
+		// Update simulation time
+		simulationTime = nextEvent.getTimeOfEvent();
+
+		// For debugging purposes, print current FEL to the command window
+		if (Trace::printsEventList) {
+			printListOfEvents(trace.console());
+			if (Instrumentation::enabled)
+				instrumentation.afterEventList();
+		}
+
+		// Serial number of the Assembly entity of this event and its station, or the part type of an
+		// arrival or the station of a downtime event, for the event trace. They are read before the event is handled, since the entity
+		// may move on or leave the system.
+		EntityHandle partSerial = 0;
+		int location = 0;
+		if (Trace::recordsEvents) {
+			if (nextEvent.getEventType() == EVENT_DEPARTURE) {
+				partSerial = entities[nextEvent.getPartID()].serialNumber;
+				location = entities[nextEvent.getPartID()].station;
+			}
+			else if (nextEvent.getEventType() != EVENT_END) {
+				location = static_cast<int>(nextEvent.getPartID());
+			}
+		}
+
+		//*****************************************************************************
+		// Perform appropriate actions depending on what the event type is.
+		//*****************************************************************************
+		(this->*handlers[nextEvent.getEventType()])(nextEvent);
+		if (Instrumentation::enabled)
+			instrumentation.afterHandler(nextEvent.getEventType());
+
+		// If end of simulation, exit while loop
+		if (simulationOver) {
+
+			return true;
+		}
+
+		// Sequentially write simulation run output to CSV file.
+		if (Trace::recordsEvents) {
+			trace.recordEvent(makeTraceRow(nextEvent, partSerial, location));
+			if (Instrumentation::enabled)
+				instrumentation.afterTrace();
+		}
+
+	} // End of while-loop
+}
+
+// End the trace of a simulation and return what it produced
+template <class FEL, class RNG, class Trace, class Stats>
+ReplicationOutput SimulationEngine<FEL, RNG, Trace, Stats>::finish(int replication, const Event &lastEvent)
+{
+	if (Trace::recordsSummary)
+		trace.endReplication(makeTraceRow(lastEvent, 0, 0));
+	else
+		trace.endReplication(TraceRow());
+
+	// Statistics of interest of this simulation
+	ReplicationOutput output;
+	output.result.simulationNumber = replication + 1;
+	output.numEvents = numEvents;
+	if (Instrumentation::enabled)
+		output.instrumentation = instrumentation.end();
+	stats.fillResult(output.result);
+	trace.moveOutput(output);
+
+	return output;
+}
+
+//////////////////////////////////////////////////
+//               Helper functions               //
+//////////////////////////////////////////////////
+
+/* For debugging purposes */
+
+// Prints list of Events to the console output, in the order in which they will occur
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::printListOfEvents(std::ostream &out) const
+{
+	std::vector<Event> pending = listOfEvents.pendingEvents();
+	for (std::vector<Event>::iterator it = pending.begin(); it != pending.end(); it++)
+		out << "Event type: " << eventTypeToCode((*it).getEventType()) << ".\t Event time: " << (*it).getTimeOfEvent() << std::endl;
+
+	out << "----------------" << std::endl;
+}
+
+// State of the system and statistics of interest after an event, for the event trace
+template <class FEL, class RNG, class Trace, class Stats>
+TraceRow SimulationEngine<FEL, RNG, Trace, Stats>::makeTraceRow(const Event &event, EntityHandle partSerial, int location) const
+{
+	TraceRow row;
+	row.simulationTime = simulationTime;
+	row.event = Event(event.getEventType(), event.getTimeOfEvent(), partSerial);
+	row.location = location;
+	row.numStations = 0;
+	for (std::size_t s = 0; s < model.stations.size() && s < static_cast<std::size_t>(maxTraceStations); ++s)
+		row.numAtStation[row.numStations++] = systemState.numAtStation[s];
+	row.totalAssembliesCreated = stats.totalAssembliesCreated();
+	row.totalAssembliesDelivered = stats.totalAssembliesDelivered();
+	row.totalTimeAssembliesInSystem = stats.totalTimeAssembliesInSystem();
+	row.cumAssemblies_Time_InSystem = stats.cumAssemblies_Time_InSystem(simulationTime);
+	row.nextID = entities.nextSerialNumber();
+	return row;
+}
+
+/* Handle new simulations. */
+
+// Reset list of Events, simulation time, statistics of interest, state of the system and
+// random number streams before a new simulation run.
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::resetAll(int replication) {
+
+	// Empty the stations, the list of events and the entities, and reset the statistics and state of system
+	Network::resetNetwork(params);
+	simulationOver = false;
+	numEvents = 0;
+
+	// Restart the random number streams for this simulation
+	randomStreams.reseed(params.masterSeed, params.streamReplication(replication), params.antitheticReplication(replication));
+}
+
+/* Snapshots */
+
+// Save the state of the simulation in a snapshot
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::saveSnapshot(const Event &nextEvent, Snapshot &snapshot) const
+{
+	snapshot.simulationTime = simulationTime;
+	snapshot.warmUpMethod = params.warmUpMethod;
+	snapshot.numEvents = numEvents;
+
+	// The next event comes first (if there is one), then the rest of the FEL in order. The end of simulation
+	// is left out.
+	std::vector<Event> pending = listOfEvents.pendingEvents();
+	snapshot.pendingEvents.clear();
+	if (nextEvent.getEventType() != EVENT_END && nextEvent.getEventType() != EVENT_NONE)
+		snapshot.pendingEvents.push_back(nextEvent);
+	for (std::size_t i = 0; i < pending.size(); ++i) {
+		if (pending[i].getEventType() != EVENT_END)
+			snapshot.pendingEvents.push_back(pending[i]);
+	}
+
+	snapshot.entityRecords = entities.allRecords();
+	snapshot.firstFreeEntity = entities.firstFree();
+	snapshot.numEntities = static_cast<std::uint32_t>(entities.size());
+	snapshot.nextSerialNumber = entities.nextSerialNumber();
+
+	snapshot.stationQueues.resize(model.stations.size());
+	for (std::size_t s = 0; s < model.stations.size(); ++s) {
+		snapshot.stationQueues[s].clear();
+		for (std::size_t i = 0; i < stationQueues[s].size(); ++i)
+			snapshot.stationQueues[s].push_back(stationQueues[s][i]);
+	}
+	snapshot.busyServers = busyServers;
+	snapshot.idleServers = idleServers;
+
+	snapshot.serverEntities.clear();
+	snapshot.serviceEnds.clear();
+	for (std::size_t k = 0; k < services.size(); ++k) {
+		snapshot.serverEntities.push_back(services[k].entity);
+		snapshot.serviceEnds.push_back(services[k].end);
+	}
+	snapshot.stationDown = stationDown;
+
+	snapshot.numAssembly = systemState.numAssembly;
+	snapshot.numAtStation = systemState.numAtStation;
+	snapshot.numParts = systemState.numParts;
+
+	snapshot.streams.clear();
+	for (std::size_t s = 0; s < randomStreams.size(); ++s)
+		snapshot.streams.push_back(randomStreams.state(static_cast<int>(s)));
+
+	snapshot.statistics.clear();
+	stats.save(snapshot.statistics);
+
+	snapshot.arrivalTracePositions.clear();
+	for (std::size_t p = 0; p < model.parts.size(); ++p)
+		snapshot.arrivalTracePositions.push_back(arrivalTraces[p].position());
+}
+
+// Restore the state of the simulation from a snapshot. The snapshot must fit the model (see snapshotFits).
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::restoreSnapshot(const Snapshot &snapshot, int replication, SnapshotMode mode)
+{
+	// Start from the empty system, with the random number streams and statistics of this simulation
+	resetAll(replication);
+	simulationTime = snapshot.simulationTime;
+
+	entities.restore(snapshot.entityRecords, snapshot.firstFreeEntity, snapshot.numEntities, snapshot.nextSerialNumber);
+
+	for (std::size_t s = 0; s < model.stations.size(); ++s) {
+		for (std::size_t i = 0; i < snapshot.stationQueues[s].size(); ++i)
+			stationQueues[s].push(snapshot.stationQueues[s][i]);
+	}
+	busyServers = snapshot.busyServers;
+	idleServers = snapshot.idleServers;
+	for (std::size_t k = 0; k < services.size(); ++k) {
+		services[k].entity = snapshot.serverEntities[k];
+		services[k].end = snapshot.serviceEnds[k];
+	}
+	stationDown = snapshot.stationDown;
+
+	// Schedule the end of simulation first, then the pending events in order, so that events scheduled for
+	// the same time keep their order. The departures get new handles.
+	listOfEvents.insert(Event(EVENT_END, params.endSimulationTime));
+	for (std::size_t i = 0; i < snapshot.pendingEvents.size(); ++i) {
+		const Event &event = snapshot.pendingEvents[i];
+		EventHandle handle = listOfEvents.insert(event);
+		if (event.getEventType() == EVENT_DEPARTURE) {
+			const EntityRecord &assembly = entities[event.getPartID()];
+			services[firstServer[assembly.station] + assembly.server].departure = handle;
+		}
+	}
+
+	systemState.numAssembly = snapshot.numAssembly;
+	systemState.numAtStation = snapshot.numAtStation;
+	systemState.numParts = snapshot.numParts;
+
+	// Both continued and forked simulations go on replaying the arrival traces from the snapshot
+	for (std::size_t p = 0; p < model.parts.size(); ++p)
+		arrivalTraces[p].reset(model.parts[p].arrivalTrace.get(), snapshot.arrivalTracePositions[p]);
+
+	if (mode == SNAPSHOT_CONTINUE) {
+
+		// Same random numbers, statistics and event count as the simulation of the snapshot
+		numEvents = snapshot.numEvents;
+		for (std::size_t s = 0; s < randomStreams.size(); ++s)
+			randomStreams.restore(static_cast<int>(s), snapshot.streams[s]);
+		stats.restore(snapshot.statistics);
+	}
+	else {
+
+		// Statistics start from the state of the snapshot: the assemblies at each station and the busy
+		// servers (those with a service under way at a station that works)
+		for (std::size_t s = 0; s < model.stations.size(); ++s) {
+			int station = static_cast<int>(s);
+			stats.onStationChange(station, simulationTime, systemState.numAtStation[s]);
+
+			for (int k = 0; k < model.stations[s].servers; ++k) {
+				if (services[firstServer[s] + k].entity != 0 && stationDown[s] == 0)
+					stats.onServerChange(station, k, simulationTime, true);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////
+/* To handle changes in the system state when an event occurs */
+////////////////////////////////////////////////////////////////
+
+// Handle the breakdown of a station: it is down until its repair
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::failure(const Event &event) {
+
+	int station = static_cast<int>(event.getPartID());
+	const Station &description = model.stations[station];
+	stopStation(station);
+	listOfEvents.insert(Event(EVENT_REPAIR, simulationTime + description.repairTime.sample(randomStreams[description.repairStream]), event.getPartID()));
+}
+
+// Handle the end of the repair of a station, and schedule its next breakdown
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::repair(const Event &event) {
+
+	int station = static_cast<int>(event.getPartID());
+	const Station &description = model.stations[station];
+	restartStation(station);
+	listOfEvents.insert(Event(EVENT_FAILURE, simulationTime + description.timeToFailure.sample(randomStreams[description.failureStream]), event.getPartID()));
+}
+
+// Handle the end of the shift of a station: it is closed until the start of the next one
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::shiftEnd(const Event &event) {
+
+	int station = static_cast<int>(event.getPartID());
+	stopStation(station);
+	listOfEvents.insert(Event(EVENT_SHIFT_START, simulationTime + model.stations[station].shiftOff, event.getPartID()));
+}
+
+// Handle the start of the shift of a station
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::shiftStart(const Event &event) {
+
+	int station = static_cast<int>(event.getPartID());
+	restartStation(station);
+	listOfEvents.insert(Event(EVENT_SHIFT_END, simulationTime + model.stations[station].shiftOn, event.getPartID()));
+}
+
+// A station goes down. The departures of the services under way are cancelled, and each server keeps the
+// service time left of its entity. The servers do not count as busy while their services are interrupted.
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::stopStation(int station) {
+
+	// Nothing more to do if the station was already down
+	if (stationDown[station]++ > 0)
+		return;
+
+	for (int k = 0; k < model.stations[station].servers; ++k) {
+		Service &service = services[firstServer[station] + k];
+		if (service.entity == 0)
+			continue;
+
+		listOfEvents.cancel(service.departure);
+		service.end -= simulationTime;
+		stats.onServerChange(station, k, simulationTime, false);
+	}
+}
+
+// A station comes back up once every reason for being down is over. The interrupted services resume
+// where they stopped, and the idle servers take the entities waiting in the queue.
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::restartStation(int station) {
+
+	if (--stationDown[station] > 0)
+		return;
+
+	for (int k = 0; k < model.stations[station].servers; ++k) {
+		Service &service = services[firstServer[station] + k];
+		if (service.entity == 0)
+			continue;
+
+		service.end += simulationTime;
+		service.departure = listOfEvents.insert(Event(EVENT_DEPARTURE, service.end, service.entity));
+		stats.onServerChange(station, k, simulationTime, true);
+	}
+
+	EntityQueue &queue = stationQueues[station];
+	while (busyServers[station] < model.stations[station].servers && !queue.empty()) {
+		startService(station, queue.front());
+		queue.pop();
+	}
+}
+
+// Handle the end of simulation event
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::endOfSimulation(const Event &) {
+
+	simulationOver = true;
+}
+
+// Handle an event that has no registered handler
+template <class FEL, class RNG, class Trace, class Stats>
+void SimulationEngine<FEL, RNG, Trace, Stats>::unknownEvent(const Event &) {
+
+	trace.console() << "Error, bad input, quitting\n";
+}
+
+#endif /* SIMULATION_ENGINE_H */
@@ -0,0 +1,356 @@
+// Definition of snapshots of the state of a simulation.
+
+#include <cstdio>
+#include <cstring> // std::memcpy, std::memset
+
+// Include header file for snapshots
+#include "Snapshot.h"
+
+// Layout of a serialized snapshot: a SnapshotHeader, then the fields of the Snapshot in order. A vector
+// is its number of elements (64 bits) followed by its elements.
+struct SnapshotHeader {
+	char magic[8];               // "DESSNAPS"
+	std::uint32_t version;
+	std::uint32_t byteOrderMark; // 0x01020304 in the byte order of the machine that wrote the snapshot
+	std::uint32_t eventSize;     // sizeof(Event)
+	std::uint32_t recordSize;    // sizeof(EntityRecord)
+	std::uint32_t streamSize;    // sizeof(RandomStream)
+	std::uint32_t reserved;
+};
+
+static const std::uint32_t snapshotVersion = 6;
+static const std::uint32_t snapshotByteOrderMark = 0x01020304;
+
+// Check that a snapshot was taken from a simulation of this model
+bool snapshotFits(const Snapshot &snapshot, const PlantModel &model, std::string &error)
+{
+	std::size_t numStations = model.stations.size();
+	if (snapshot.stationQueues.size() != numStations || snapshot.busyServers.size() != numStations ||
+		snapshot.numAtStation.size() != numStations || snapshot.stationDown.size() != numStations) {
+		error = "the snapshot has " + std::to_string(snapshot.numAtStation.size()) + " stations, the model " + std::to_string(numStations);
+		return false;
+	}
+	if (snapshot.idleServers.size() != static_cast<std::size_t>(model.numServers()) ||
+		snapshot.serverEntities.size() != snapshot.idleServers.size() || snapshot.serviceEnds.size() != snapshot.idleServers.size()) {
+		error = "the snapshot has " + std::to_string(snapshot.idleServers.size()) + " servers, the model " + std::to_string(model.numServers());
+		return false;
+	}
+	if (snapshot.numParts.size() != model.parts.size()) {
+		error = "the snapshot has " + std::to_string(snapshot.numParts.size()) + " part types, the model " + std::to_string(model.parts.size());
+		return false;
+	}
+	if (snapshot.arrivalTracePositions.size() != model.parts.size()) {
+		error = "the snapshot has the arrival trace positions of " + std::to_string(snapshot.arrivalTracePositions.size()) +
+			" part types, the model " + std::to_string(model.parts.size());
+		return false;
+	}
+	for (std::size_t p = 0; p < model.parts.size(); ++p) {
+		const ArrivalTrace *trace = model.parts[p].arrivalTrace.get();
+		std::uint64_t position = snapshot.arrivalTracePositions[p];
+		if (trace && (position > trace->size() || (trace->fileFormat() == ARRIVALS_BINARY && position % sizeof(double) != 0))) {
+			error = "the snapshot position " + std::to_string(position) + " is not in the arrival trace " + trace->path() +
+				" of part type " + model.parts[p].name;
+			return false;
+		}
+	}
+	if (snapshot.streams.size() != static_cast<std::size_t>(model.numStreams)) {
+		error = "the snapshot has " + std::to_string(snapshot.streams.size()) + " random number streams, the model " + std::to_string(model.numStreams);
+		return false;
+	}
+
+	// Everything the state refers to by index must exist: the entities, and their stations and servers
+	std::size_t numRecords = snapshot.entityRecords.size();
+	auto isEntity = [&](EntityHandle handle) { return handle >= 1 && handle <= numRecords; };
+	error = "the snapshot is damaged: ";
+	if (snapshot.firstFreeEntity > numRecords || snapshot.numEntities > numRecords) {
+		error += "the entity store is out of range";
+		return false;
+	}
+	for (std::size_t i = 0; i < numRecords; ++i) {
+		const EntityRecord &record = snapshot.entityRecords[i];
+		if (record.nextFree > numRecords || record.station >= numStations || record.server >= model.stations[record.station].servers) {
+			error += "entity " + std::to_string(i + 1) + " is out of range";
+			return false;
+		}
+	}
+
+	std::size_t firstServer = 0;
+	for (std::size_t s = 0; s < numStations; ++s) {
+		int servers = model.stations[s].servers;
+		for (std::size_t i = 0; i < snapshot.stationQueues[s].size(); ++i) {
+			if (!isEntity(snapshot.stationQueues[s][i])) {
+				error += "the queue of station " + model.stations[s].name + " has an entity out of range";
+				return false;
+			}
+		}
+		if (snapshot.busyServers[s] < 0 || snapshot.busyServers[s] > servers || snapshot.stationDown[s] < 0) {
+			error += "the servers of station " + model.stations[s].name + " are out of range";
+			return false;
+		}
+		for (int k = 0; k < servers; ++k) {
+			EntityHandle entity = snapshot.serverEntities[firstServer + k];
+			if (snapshot.idleServers[firstServer + k] >= servers || (entity != 0 && !isEntity(entity))) {
+				error += "the servers of station " + model.stations[s].name + " are out of range";
+				return false;
+			}
+		}
+		firstServer += servers;
+	}
+
+	for (std::size_t i = 0; i < snapshot.pendingEvents.size(); ++i) {
+		const Event &event = snapshot.pendingEvents[i];
+		std::uint32_t ID = event.getPartID();
+		bool valid;
+		switch (event.getEventType()) {
+		case EVENT_ARRIVAL:
+			valid = ID < model.parts.size();
+			break;
+		case EVENT_DEPARTURE:
+			valid = isEntity(ID);
+			break;
+		case EVENT_FAILURE:
+		case EVENT_REPAIR:
+		case EVENT_SHIFT_END:
+		case EVENT_SHIFT_START:
+			valid = ID < numStations;
+			break;
+		default:
+			valid = false;
+			break;
+		}
+		if (!valid) {
+			error += "pending event " + std::to_string(i) + " is out of range";
+			return false;
+		}
+	}
+
+	error.clear();
+	return true;
+}
+
+/* Serialization */
+
+// Append raw bytes
+static void put(std::vector<char> &bytes, const void *data, std::size_t size)
+{
+	const char *begin = static_cast<const char *>(data);
+	bytes.insert(bytes.end(), begin, begin + size);
+}
+
+template <class T>
+static void putValue(std::vector<char> &bytes, const T &value)
+{
+	put(bytes, &value, sizeof(value));
+}
+
+template <class T>
+static void putVector(std::vector<char> &bytes, const std::vector<T> &values)
+{
+	putValue(bytes, static_cast<std::uint64_t>(values.size()));
+	if (!values.empty())
+		put(bytes, &values[0], values.size() * sizeof(T));
+}
+
+// Reads raw bytes in order. Reading past the end sets 'failed' and leaves the values untouched.
+class SnapshotReader {
+public:
+	explicit SnapshotReader(const std::vector<char> &data) : bytes(data), position(0), failed(false) {}
+
+	void get(void *data, std::size_t size)
+	{
+		if (failed || size > bytes.size() - position) {
+			failed = true;
+			return;
+		}
+		std::memcpy(data, &bytes[position], size);
+		position += size;
+	}
+
+	template <class T>
+	void getValue(T &value)
+	{
+		get(&value, sizeof(value));
+	}
+
+	template <class T>
+	void getVector(std::vector<T> &values)
+	{
+		std::uint64_t size = 0;
+		getValue(size);
+		if (failed || size > (bytes.size() - position) / sizeof(T)) {
+			failed = true;
+			return;
+		}
+		values.resize(static_cast<std::size_t>(size));
+		if (size > 0)
+			get(&values[0], values.size() * sizeof(T));
+	}
+
+	bool ok() const { return !failed; }
+	bool atEnd() const { return position == bytes.size(); }
+
+private:
+	const std::vector<char> &bytes;
+	std::size_t position;
+	bool failed;
+};
+
+// Convert a snapshot to bytes
+void serializeSnapshot(const Snapshot &snapshot, std::vector<char> &bytes)
+{
+	SnapshotHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DESSNAPS", 8);
+	header.version = snapshotVersion;
+	header.byteOrderMark = snapshotByteOrderMark;
+	header.eventSize = sizeof(Event);
+	header.recordSize = sizeof(EntityRecord);
+	header.streamSize = sizeof(RandomStream);
+
+	bytes.clear();
+	putValue(bytes, header);
+
+	putValue(bytes, snapshot.simulationTime);
+	putValue(bytes, static_cast<std::int32_t>(snapshot.replication));
+	putValue(bytes, static_cast<std::int32_t>(snapshot.warmUpMethod));
+	putValue(bytes, static_cast<std::uint64_t>(snapshot.numEvents));
+	putValue(bytes, snapshot.scenarioKey);
+
+	putVector(bytes, snapshot.pendingEvents);
+
+	putVector(bytes, snapshot.entityRecords);
+	putValue(bytes, snapshot.firstFreeEntity);
+	putValue(bytes, snapshot.numEntities);
+	putValue(bytes, snapshot.nextSerialNumber);
+
+	putValue(bytes, static_cast<std::uint64_t>(snapshot.stationQueues.size()));
+	for (std::size_t s = 0; s < snapshot.stationQueues.size(); ++s)
+		putVector(bytes, snapshot.stationQueues[s]);
+	putVector(bytes, snapshot.busyServers);
+	putVector(bytes, snapshot.idleServers);
+	putVector(bytes, snapshot.serverEntities);
+	putVector(bytes, snapshot.serviceEnds);
+	putVector(bytes, snapshot.stationDown);
+
+	putValue(bytes, static_cast<std::int32_t>(snapshot.numAssembly));
+	putVector(bytes, snapshot.numAtStation);
+	putVector(bytes, snapshot.numParts);
+
+	putVector(bytes, snapshot.streams);
+	putVector(bytes, snapshot.statistics);
+	putVector(bytes, snapshot.arrivalTracePositions);
+}
+
+// Convert bytes back to a snapshot
+bool deserializeSnapshot(const std::vector<char> &bytes, Snapshot &snapshot, std::string &error)
+{
+	SnapshotReader reader(bytes);
+
+	SnapshotHeader header;
+	reader.getValue(header);
+	if (!reader.ok() || std::memcmp(header.magic, "DESSNAPS", 8) != 0) {
+		error = "not a snapshot";
+		return false;
+	}
+	if (header.version != snapshotVersion || header.byteOrderMark != snapshotByteOrderMark ||
+		header.eventSize != sizeof(Event) || header.recordSize != sizeof(EntityRecord) || header.streamSize != sizeof(RandomStream)) {
+		error = "the snapshot was written by another version of the program or on another kind of machine";
+		return false;
+	}
+
+	std::int32_t replication = 0, warmUpMethod = 0, numAssembly = 0;
+	std::uint64_t numEvents = 0, numQueues = 0;
+
+	reader.getValue(snapshot.simulationTime);
+	reader.getValue(replication);
+	reader.getValue(warmUpMethod);
+	reader.getValue(numEvents);
+	reader.getValue(snapshot.scenarioKey);
+
+	reader.getVector(snapshot.pendingEvents);
+
+	reader.getVector(snapshot.entityRecords);
+	reader.getValue(snapshot.firstFreeEntity);
+	reader.getValue(snapshot.numEntities);
+	reader.getValue(snapshot.nextSerialNumber);
+
+	reader.getValue(numQueues);
+	if (reader.ok() && numQueues <= bytes.size()) {
+		snapshot.stationQueues.resize(static_cast<std::size_t>(numQueues));
+		for (std::size_t s = 0; s < snapshot.stationQueues.size(); ++s)
+			reader.getVector(snapshot.stationQueues[s]);
+	}
+	reader.getVector(snapshot.busyServers);
+	reader.getVector(snapshot.idleServers);
+	reader.getVector(snapshot.serverEntities);
+	reader.getVector(snapshot.serviceEnds);
+	reader.getVector(snapshot.stationDown);
+
+	reader.getValue(numAssembly);
+	reader.getVector(snapshot.numAtStation);
+	reader.getVector(snapshot.numParts);
+
+	reader.getVector(snapshot.streams);
+	reader.getVector(snapshot.statistics);
+	reader.getVector(snapshot.arrivalTracePositions);
+
+	if (!reader.ok() || !reader.atEnd() || numQueues > bytes.size()) {
+		error = "the snapshot is truncated or damaged";
+		return false;
+	}
+
+	snapshot.replication = replication;
+	snapshot.warmUpMethod = warmUpMethod;
+	snapshot.numEvents = numEvents;
+	snapshot.numAssembly = numAssembly;
+
+	return true;
+}
+
+// Write a snapshot to a file
+bool writeSnapshot(const std::string &path, const Snapshot &snapshot, std::string &error)
+{
+	std::vector<char> bytes;
+	serializeSnapshot(snapshot, bytes);
+
+	std::FILE *file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		error = "cannot create " + path;
+		return false;
+	}
+
+	bool written = std::fwrite(&bytes[0], 1, bytes.size(), file) == bytes.size();
+	if (std::fclose(file) != 0)
+		written = false;
+
+	if (!written) {
+		error = "cannot write " + path;
+		return false;
+	}
+
+	return true;
+}
+
+// Read a snapshot from a file
+bool readSnapshot(const std::string &path, Snapshot &snapshot, std::string &error)
+{
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		error = "cannot open " + path;
+		return false;
+	}
+
+	std::vector<char> bytes;
+	char buffer[65536];
+	std::size_t count;
+	while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+		bytes.insert(bytes.end(), buffer, buffer + count);
+	std::fclose(file);
+
+	if (!deserializeSnapshot(bytes, snapshot, error)) {
+		error = path + ": " + error;
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,91 @@
+// Header file for snapshots of the state of a simulation
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Event.h"
+#include "EntityStore.h"
+#include "PlantModel.h"
+#include "RandomStream.h"
+
+// How a simulation starts from a snapshot
+enum SnapshotMode {
+	SNAPSHOT_CONTINUE, // The simulation of the snapshot goes on with the same random numbers and statistics,
+	                   // as if it had never stopped (e.g. to restart a long run after an interruption)
+	SNAPSHOT_FORK      // A new simulation starts from the state of the snapshot, with the random number streams of
+	                   // its own simulation number. Statistics are recorded from the time of the snapshot on.
+};
+
+// Simulation number of a warm-up run whose snapshot is forked into simulations 0, 1, 2, ... Its random
+// number streams are not used by any of them.
+static const int warmUpReplication = 1 << 30;
+
+// The complete state of a simulation at a point in time, between two events: the FEL, the entities,
+// the station queues and servers, the state of the system, the random number streams and the statistics.
+// A snapshot is a plain copy, so it can be shared (read only) by simulations running in parallel.
+//
+// Forked simulations are statistically independent given the snapshot: they share its warm state,
+// including the events already scheduled in its FEL, and then draw their own random numbers.
+struct Snapshot {
+	Snapshot() : simulationTime(0), replication(0), warmUpMethod(WARMUP_FIXED), numEvents(0), scenarioKey(0),
+		firstFreeEntity(0), numEntities(0), nextSerialNumber(1), numAssembly(0) {}
+
+	double simulationTime;
+	int replication;                   // Simulation number (starting at 0) the snapshot was taken from
+	int warmUpMethod;                  // Warm-up method of that simulation, which decides the layout of 'statistics'
+	unsigned long long numEvents;      // Number of events executed so far
+	std::uint64_t scenarioKey;         // Hash of the model inputs, master seed included, of that simulation (see
+	                                   // ResultsCache::scenarioKey), to tell whether a saved snapshot is still of them
+
+	// Pending events in the order in which they will occur (the end of simulation event is not kept: it is
+	// scheduled again when the simulation starts from the snapshot, so a run can be extended)
+	std::vector<Event> pendingEvents;
+
+	// The entity store
+	std::vector<EntityRecord> entityRecords;
+	EntityHandle firstFreeEntity;
+	std::uint32_t numEntities;
+	std::uint32_t nextSerialNumber;
+
+	// The queue of each station (front first), the busy servers and the stacks of idle servers
+	std::vector<std::vector<EntityHandle> > stationQueues;
+	std::vector<int> busyServers;
+	std::vector<std::uint16_t> idleServers;
+
+	// The service under way on each server (the servers of every station in turn): its entity (0 if the
+	// server is idle), and the time of its departure, or the service time left while its station is down
+	std::vector<EntityHandle> serverEntities;
+	std::vector<double> serviceEnds;
+
+	// Number of reasons why each station is down (see SimulationEngine.h)
+	std::vector<int> stationDown;
+
+	// The state of the system
+	int numAssembly;
+	std::vector<int> numAtStation;
+	std::vector<int> numParts;
+
+	std::vector<RandomStream> streams;
+	std::vector<double> statistics;    // State of the statistics policy (see StatisticsPolicies.h)
+	std::vector<std::uint64_t> arrivalTracePositions; // Byte offset of the next arrival in the trace of each part type (see ArrivalTrace.h)
+};
+
+// Check that a snapshot was taken from a simulation of this model: the numbers of stations, servers, part
+// types and streams, and every entity handle, station, server and event in it are in range, so that a
+// damaged file cannot be restored. Returns false with a message if not. It does not check that the inputs
+// of the model are the same (compare scenarioKey for that).
+bool snapshotFits(const Snapshot &, const PlantModel &, std::string &error);
+
+// Convert a snapshot to bytes and back. The bytes start with a header like a binary trace file, and
+// are only read back on a machine with the same byte order and the same layout of the records.
+void serializeSnapshot(const Snapshot &, std::vector<char> &bytes);
+bool deserializeSnapshot(const std::vector<char> &bytes, Snapshot &, std::string &error);
+
+// Write a snapshot to a file and read it back. Return false with a message if they fail.
+bool writeSnapshot(const std::string &path, const Snapshot &, std::string &error);
+bool readSnapshot(const std::string &path, Snapshot &, std::string &error);
+
+#endif /* SNAPSHOT_H */
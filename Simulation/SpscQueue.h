@@ -0,0 +1,87 @@
+// Header file for the single-producer single-consumer queue
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// An unbounded first-in first-out queue between exactly one producer thread and one consumer thread,
+// without locks. Items are stored in segments of 'SegmentSize' items: the producer fills the last
+// segment and publishes each item by increasing the count of the segment, the consumer reads the first
+// segment and frees it once it has read all of it. The producer never waits for the consumer, so two
+// threads sending items to each other cannot block each other.
+template <class T, std::size_t SegmentSize = 256>
+class SpscQueue {
+public:
+	SpscQueue()
+	{
+		head = tail = new Segment;
+		readIndex = 0;
+	}
+
+	~SpscQueue()
+	{
+		while (head) {
+			Segment *next = head->next.load(std::memory_order_relaxed);
+			delete head;
+			head = next;
+		}
+	}
+
+	// Producer: append an item
+	void push(const T &item)
+	{
+		std::size_t count = tail->count.load(std::memory_order_relaxed);
+		if (count == SegmentSize) {
+			Segment *segment = new Segment;
+			tail->next.store(segment, std::memory_order_release);
+			tail = segment;
+			count = 0;
+		}
+
+		tail->items[count] = item;
+		tail->count.store(count + 1, std::memory_order_release);
+	}
+
+	// Consumer: the first item, or 0 if the queue is empty
+	const T *front()
+	{
+		if (readIndex == SegmentSize) {
+			Segment *next = head->next.load(std::memory_order_acquire);
+			if (!next)
+				return 0;
+			delete head;
+			head = next;
+			readIndex = 0;
+		}
+
+		if (readIndex < head->count.load(std::memory_order_acquire))
+			return &head->items[readIndex];
+		return 0;
+	}
+
+	// Consumer: remove the first item (the queue must not be empty)
+	void pop()
+	{
+		readIndex++;
+	}
+
+private:
+	struct Segment {
+		Segment() : count(0), next(0) {}
+
+		T items[SegmentSize];
+		std::atomic<std::size_t> count;  // Number of items published by the producer
+		std::atomic<Segment *> next;
+	};
+
+	SpscQueue(const SpscQueue &);
+	SpscQueue &operator=(const SpscQueue &);
+
+	Segment *head;         // Consumer: segment being read
+	std::size_t readIndex; // Consumer: next item of 'head'
+	char padding[64];      // Keeps the fields of the two threads on different cache lines
+	Segment *tail;         // Producer: segment being filled
+};
+
+#endif /* SPSC_QUEUE_H */
@@ -0,0 +1,338 @@
+// Header file for class template StationNetwork
+#ifndef STATION_NETWORK_H
+#define STATION_NETWORK_H
+
+#include <vector>
+
+#include "Event.h"
+#include "EntityStore.h"
+#include "Instrumentation.h"
+#include "ModelParameters.h"
+#include "PlantModel.h"
+#include "Simulation.h"
+
+// The stations of a PlantModel, with their queues and servers, the parts waiting to be kitted, and the event
+// handlers that move the Assembly entities through them. SimulationEngine keeps the whole plant in one, and
+// ParallelSimulationEngine one per logical process (see ParallelEngine.h), so both run the same handlers.
+//
+// Where an entity goes when it leaves a station is up to the engine, the class that derives from this one
+// (Derived): departure calls Derived::sendTo(station, ID) with the next station of its route. SimulationEngine
+// has it arrive at once; a logical process has it arrive at one of its own stations, or sends it as a
+// message to the process of the station.
+//
+// FEL, RNG and Stats are the policies of SimulationEngine. The state is public, for the engine that derives
+// from this class (privately, for SimulationEngine) and whose other handlers change it too.
+template <class Derived, class FEL, class RNG, class Stats>
+class StationNetwork {
+public:
+	// Constructor. The model must outlive the network.
+	explicit StationNetwork(const PlantModel &);
+
+	// Empty the FEL, the stations and the entities, and reset the statistics and the state of the system, at
+	// simulation time 0. The random number streams are reseeded by the engine.
+	void resetNetwork(const ModelParameters &);
+
+	// To handle changes in the system state when an event occurs
+	void createAssemblyEntities(void);
+	void arriveAtStation(int station, EntityHandle);
+	void startService(int station, EntityHandle);
+	void arrival(const Event &);
+	void departure(const Event &);
+
+	// Schedule the next arrival of a part type: drawn from its interarrival distribution, or the next one of its
+	// arrival trace (none at the end of the trace)
+	void scheduleArrival(std::uint32_t type);
+
+	const PlantModel &model;
+
+	// Declare list of events (the Future Event list, FEL). Events are kept in time order, and events
+	// scheduled for the same time are executed in the order in which they were scheduled.
+	FEL listOfEvents;
+
+	// Declare the random number streams of the current replication. There is one long-lived stream per
+	// stochastic source (arrivals, inspections, service times and routing), numbered by the model.
+	RNG randomStreams;
+
+	Stats stats;
+	Instrumentation instrumentation;
+
+	// Declare simulation time variable.
+	double simulationTime;
+
+	// Declare the Assembly entities currently in the system: their creation times, how often they have
+	// undergone rework, the station they are at and the stations they visited. The part ID of a departure
+	// is the handle of its entity.
+	EntityStore entities;
+
+	// Declare the queue of part IDs of Assembly entities waiting at each station, in First In First Out order
+	std::vector<EntityQueue> stationQueues;
+
+	// Declare the number of busy servers of each station
+	std::vector<int> busyServers;
+
+	// Declare the idle servers of each station, as a stack: the servers of station s occupy
+	// idleServers[firstServer[s]], ..., idleServers[firstServer[s] + servers - 1], and the idle ones are
+	// the first (servers - busyServers[s]) of them. The most recently freed server is used first.
+	std::vector<int> firstServer;
+	std::vector<std::uint16_t> idleServers;
+
+	// Declare the service under way on each server, at index firstServer[s] + server: the Assembly entity
+	// served (0 if the server is idle), the handle of its departure event, and the time of its departure,
+	// or the service time left while the station is down
+	struct Service {
+		EntityHandle entity;
+		EventHandle departure;
+		double end;
+	};
+	std::vector<Service> services;
+
+	// Declare the number of reasons why each station is down (a breakdown, the end of its shift): 0 if it works
+	std::vector<int> stationDown;
+
+	// State of the system. With logical processes, each counts the assemblies it created or delivered in
+	// numAssembly, so only the sum over the processes is the number in the system.
+	state_t systemState;
+
+	// Position of the simulation in the arrival trace of each part type that has one
+	std::vector<ArrivalTraceReader> arrivalTraces;
+};
+
+// Constructor. Size the state of the system for the model.
+template <class Derived, class FEL, class RNG, class Stats>
+StationNetwork<Derived, FEL, RNG, Stats>::StationNetwork(const PlantModel &plantModel)
+	: model(plantModel), simulationTime(0)
+{
+	randomStreams.resize(model.numStreams);
+	stationQueues.resize(model.stations.size());
+	busyServers.resize(model.stations.size());
+	firstServer.resize(model.stations.size());
+	idleServers.resize(model.numServers());
+	services.resize(model.numServers());
+	stationDown.resize(model.stations.size());
+	for (std::size_t s = 0, first = 0; s < model.stations.size(); first += model.stations[s].servers, ++s)
+		firstServer[s] = static_cast<int>(first);
+	systemState.numAtStation.resize(model.stations.size());
+	systemState.numParts.resize(model.parts.size());
+	arrivalTraces.resize(model.parts.size());
+}
+
+// Empty the stations and reset the statistics before a new simulation run
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::resetNetwork(const ModelParameters &params)
+{
+	// Set simulation time to zero
+	simulationTime = 0;
+
+	// Clears all elements from the list of events
+	listOfEvents.clear();
+
+	// Clears all Assembly entities. Part IDs restart at 1.
+	// Remember that an ID of 0 is a tag for an invalid ID (i.e. no ID)
+	entities.clear();
+
+	// Clears all queues and servers. All servers are idle, with server 0 on top of the stack.
+	for (std::size_t s = 0; s < model.stations.size(); ++s) {
+		stationQueues[s].clear();
+		busyServers[s] = 0;
+
+		int servers = model.stations[s].servers;
+		for (int k = 0; k < servers; ++k) {
+			idleServers[firstServer[s] + k] = static_cast<std::uint16_t>(servers - 1 - k);
+			services[firstServer[s] + k].entity = 0;
+		}
+		stationDown[s] = 0;
+	}
+
+	// Reset statistics of interest
+	stats.reset(params, model);
+
+	// Reset state of system
+	systemState.numAssembly = 0;
+	systemState.numAtStation.assign(model.stations.size(), 0);
+	systemState.numParts.assign(model.parts.size(), 0);
+
+	// Replay the arrival traces from the start
+	for (std::size_t p = 0; p < model.parts.size(); ++p)
+		arrivalTraces[p].reset(model.parts[p].arrivalTrace.get());
+}
+
+////////////////////////////////////////////////////////////////
+/* To handle changes in the system state when an event occurs */
+////////////////////////////////////////////////////////////////
+
+// While there is a complete kit of parts in the system, create a new assembly entity, send it to
+// the first station, and reduce the number of parts of each type in the system by their kit quantity.
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::createAssemblyEntities(void) {
+
+	while (1) {
+
+		// Check that there are enough parts of each type
+		for (std::size_t p = 0; p < model.parts.size(); ++p) {
+			if (systemState.numParts[p] < model.parts[p].kitQuantity)
+				return;
+		}
+
+		// Increment total number of assembly entities created
+		stats.onAssemblyCreated(simulationTime);
+
+		// Reduce the number of each part in the system
+		for (std::size_t p = 0; p < model.parts.size(); ++p)
+			systemState.numParts[p] -= model.parts[p].kitQuantity;
+
+		// Create the new assembly entity, which records its creation time, and send it to the first station
+		systemState.numAssembly++;
+		arriveAtStation(model.kitStation, entities.create(simulationTime));
+	}
+}
+
+// An assembly entity arrives at a station. It is served at once if a server is idle and the station
+// works, and waits in the station queue otherwise.
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::arriveAtStation(int station, EntityHandle ID) {
+
+	// Increment the number of assembly entities in the station or in its queue
+	systemState.numAtStation[station]++;
+	entities.visit(ID, static_cast<std::uint16_t>(station), simulationTime);
+
+	if (busyServers[station] < model.stations[station].servers && stationDown[station] == 0)
+		startService(station, ID);
+	else {
+		stationQueues[station].push(ID);
+		if (Instrumentation::enabled)
+			instrumentation.queueLength(station, stationQueues[station].size());
+	}
+
+	stats.onStationChange(station, simulationTime, systemState.numAtStation[station]);
+}
+
+// Start the service of an assembly entity on an idle server, and schedule its departure from the station
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::startService(int station, EntityHandle ID) {
+
+	const Station &description = model.stations[station];
+
+	// Take the idle server on top of the stack
+	int idle = description.servers - busyServers[station];
+	std::uint16_t server = idleServers[firstServer[station] + idle - 1];
+	busyServers[station]++;
+	entities[ID].server = server;
+	stats.onServerChange(station, server, simulationTime, true);
+	stats.onServiceStart(station, simulationTime, entities[ID].arrivalTime);
+
+	Service &service = services[firstServer[station] + server];
+	service.entity = ID;
+	service.end = simulationTime + description.service.sample(randomStreams[description.serviceStream]);
+	service.departure = listOfEvents.insert(Event(EVENT_DEPARTURE, service.end, ID));
+}
+
+// Execute system state changes when an arrival of a part occurs
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::arrival(const Event &event) {
+
+	std::uint32_t type = event.getPartID();
+	const PartType &part = model.parts[type];
+
+	// Inspect the part. If it is accepted, increment the number of parts of its type in the system.
+	bool partAccepted = randomStreams[part.inspectionStream].bernoulli(part.acceptProbability);
+	if (partAccepted)
+		systemState.numParts[type]++;
+
+	// Schedule a new arrival event
+	scheduleArrival(type);
+
+	if (partAccepted == true) {
+
+		// If there is a complete kit of parts, create a new assembly entity
+		createAssemblyEntities();
+	}
+}
+
+// Schedule the next arrival of a part type. A recorded arrival earlier than the current time (a trace out
+// of order) happens at once.
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::scheduleArrival(std::uint32_t type)
+{
+	const PartType &part = model.parts[type];
+	if (!part.arrivalTrace) {
+		listOfEvents.insert(Event(EVENT_ARRIVAL, simulationTime + part.interArrival.sample(randomStreams[part.arrivalStream]), type));
+		return;
+	}
+
+	double time;
+	if (arrivalTraces[type].next(time))
+		listOfEvents.insert(Event(EVENT_ARRIVAL, (time < simulationTime) ? simulationTime : time, type));
+}
+
+// Handle system changes when an assembly entity leaves the station it is at. The same handler serves
+// every station: the station is read from the entity, and its next step from the routes of the station.
+template <class Derived, class FEL, class RNG, class Stats>
+void StationNetwork<Derived, FEL, RNG, Stats>::departure(const Event &event) {
+
+	EntityHandle ID = event.getPartID();
+	EntityRecord &assembly = entities[ID];
+	int station = assembly.station;
+	const Station &description = model.stations[station];
+
+	// Reduce the number of assembly entities in the station or in its queue, and put the server back
+	// on the stack of idle servers
+	systemState.numAtStation[station]--;
+	idleServers[firstServer[station] + description.servers - busyServers[station]] = assembly.server;
+	busyServers[station]--;
+	services[firstServer[station] + assembly.server].entity = 0;
+	stats.onServerChange(station, assembly.server, simulationTime, false);
+
+	// If there are assembly entities waiting in the queue, start the service of the next one
+	EntityQueue &queue = stationQueues[station];
+	if (!queue.empty()) {
+		startService(station, queue.front());
+		queue.pop();
+	}
+
+	stats.onStationChange(station, simulationTime, systemState.numAtStation[station]);
+
+	// Keep a note that this part has undergone rework
+	if (description.rework)
+		assembly.reworkCount++;
+
+	////////////////////////////////////////
+	//				Routing				  //
+	////////////////////////////////////////
+
+	// The routes depend on whether the Assembly entity has undergone rework or not. With more than one
+	// route, pick one with a random number in the range 0 to 1.
+	const std::vector<Route> &routes = description.routesFor(assembly.reworkCount > 0);
+	int destination = ROUTE_EXIT;
+	if (routes.size() == 1) {
+		destination = routes[0].destination;
+	}
+	else if (!routes.empty()) {
+		double prob = randomStreams[description.routingStream].uniform();
+		double cumulative = 0;
+		destination = routes.back().destination;
+		for (std::size_t r = 0; r + 1 < routes.size(); ++r) {
+			cumulative += routes[r].probability;
+			if (prob < cumulative) {
+				destination = routes[r].destination;
+				break;
+			}
+		}
+	}
+
+	if (destination == ROUTE_EXIT) {
+
+		// Record the delivery of this assembly entity and the total amount of time it spent in the system
+		stats.onAssemblyDelivered(station, simulationTime, assembly.creationTime, assembly.reworkCount);
+
+		// The assembly entity leaves the system
+		systemState.numAssembly--;
+		entities.release(ID);
+	}
+	else {
+
+		// The engine sends it on to the next station
+		static_cast<Derived &>(*this).sendTo(destination, ID);
+	}
+}
+
+#endif /* STATION_NETWORK_H */
@@ -0,0 +1,807 @@
+// Header file for the statistics policies of the simulation engine
+#ifndef STATISTICS_POLICIES_H
+#define STATISTICS_POLICIES_H
+
+#include <vector>
+#include <algorithm> // std::copy, std::fill
+#include <cstddef>
+#include <limits>    // std::numeric_limits
+
+#include "ModelParameters.h"
+#include "PlantModel.h"
+#include "Simulation.h"
+#include "OutputAnalysis.h"
+#include "QuantileSketch.h"
+
+// A statistics policy decides which statistics of interest a simulation records. It provides:
+//   void reset(const ModelParameters &, const PlantModel &);
+//   void onStationChange(int station, double time, int numAtStation);        // After an entity comes or goes
+//   void onServerChange(int station, int server, double time, bool busy);   // After a server starts or ends a service
+//   void onServiceStart(int station, double time, double arrivalTime);     // The entity had arrived at 'arrivalTime'
+//   void onAssemblyCreated(double time);
+//   void onAssemblyDelivered(int station, double time, double creationTime, int reworkCount); // It left from 'station'
+//   void fillResult(ReplicationResult &) const;
+//   void save(std::vector<double> &) const;   // Append the state of the statistics (for a Snapshot)
+//   void restore(const std::vector<double> &); // Restore a saved state, after reset
+// and the running totals written to the event trace (totalAssembliesCreated() and so on; the time-weighted
+// total takes the current time). Time-weighted statistics are kept per station and per server and only
+// brought up to date when they change, so the cost of an event does not grow with the number of stations
+// or servers.
+
+// Integral over time of a quantity that only changes at events (e.g. the number of busy servers of a
+// station), counted from time 'start' on. The integral is brought up to date when the quantity changes.
+class TimeIntegral {
+public:
+	void reset(double startTime)
+	{
+		start = startTime;
+		last = 0;
+		value = 0;
+		area = 0;
+	}
+
+	// The quantity takes a new value at 'time'
+	void set(double time, double newValue)
+	{
+		area = areaAt(time);
+		last = time;
+		value = newValue;
+	}
+
+	double current() const { return value; }
+
+	// Append the state to 'out', and restore it from in[i], in[i + 1], ... (returns the next index)
+	void save(std::vector<double> &out) const
+	{
+		out.push_back(start);
+		out.push_back(last);
+		out.push_back(value);
+		out.push_back(area);
+	}
+
+	std::size_t restore(const std::vector<double> &in, std::size_t i)
+	{
+		start = in[i];
+		last = in[i + 1];
+		value = in[i + 2];
+		area = in[i + 3];
+		return i + 4;
+	}
+
+	// Integral up to 'time' (at or after the last change)
+	double areaAt(double time) const
+	{
+		double from = (last > start) ? last : start;
+		return (time > from) ? area + value * (time - from) : area;
+	}
+
+private:
+	double start; // Nothing is counted before this time
+	double last;  // Time of the last change
+	double value;
+	double area;  // Integral up to 'last'
+};
+
+// Fill the utilization of each station (the average of its servers) from result.serverUtilization.
+// The servers of station s are firstServer[s], ..., firstServer[s + 1] - 1.
+inline void fillStationUtilization(ReplicationResult &result, const std::vector<int> &firstServer)
+{
+	std::size_t numStations = firstServer.size() - 1;
+	result.stationUtilization.assign(numStations, 0.0);
+	for (std::size_t s = 0; s < numStations; ++s) {
+		for (int k = firstServer[s]; k < firstServer[s + 1]; ++k)
+			result.stationUtilization[s] += result.serverUtilization[k];
+		result.stationUtilization[s] /= firstServer[s + 1] - firstServer[s];
+	}
+}
+
+// Statistics of interest recorded after the ramp-up time. Every total is kept per station (the assemblies
+// at the station, its deliveries and its servers) and only added up over the stations at the end, so the
+// totals of each station only depend on the events of that station: a simulation split over several
+// logical processes (see ParallelEngine.h) gets exactly the same results.
+class SteadyStateStatistics {
+public:
+	void reset(const ModelParameters &params, const PlantModel &model)
+	{
+		rampUpTime = params.rampUpTime;
+		endTime = params.endSimulationTime;
+		timeOfInterest = params.timeOfInterest();
+		assemblyStation = model.assemblyStation;
+		reworkStation = model.reworkStation;
+
+		created = 0;
+		stations.resize(model.stations.size());
+		for (std::size_t s = 0; s < stations.size(); ++s) {
+			stations[s].delivered = 0;
+			stations[s].timeInSystem = 0;
+			stations[s].inSystem.reset(rampUpTime);
+			stations[s].timeInSystemDistribution.clear();
+			stations[s].reworkDistribution = QuantileSketch(1);
+			stations[s].waitingTimeDistribution.clear();
+		}
+
+		firstServer.resize(model.stations.size() + 1);
+		firstServer[0] = 0;
+		for (std::size_t s = 0; s < model.stations.size(); ++s)
+			firstServer[s + 1] = firstServer[s] + model.stations[s].servers;
+
+		servers.resize(firstServer.back());
+		for (std::size_t k = 0; k < servers.size(); ++k)
+			servers[k].reset(rampUpTime);
+	}
+
+	// Update the number of assemblies at a station. Only the time after the ramp-up time is counted.
+	void onStationChange(int station, double time, int numAt)
+	{
+		stations[station].inSystem.set(time, numAt);
+	}
+
+	// Update the busy time of a server. Only the time after the ramp-up time is counted.
+	void onServerChange(int station, int server, double time, bool busy)
+	{
+		servers[firstServer[station] + server].set(time, busy ? 1 : 0);
+	}
+
+	// Record the time an assembly entity waited in the queue of a station, if its service starts after the ramp-up time
+	void onServiceStart(int station, double time, double arrivalTime)
+	{
+		if (time > rampUpTime)
+			stations[station].waitingTimeDistribution.add(time - arrivalTime);
+	}
+
+	// Increment total number of assembly entities created if simulation time is beyond ramp-up time
+	void onAssemblyCreated(double time)
+	{
+		if (time > rampUpTime)
+			created++;
+	}
+
+	// Increment the number of Assembly parts that have been delivered by a station, and add the time spent
+	// by the assembly entity in the system, if simulation time is greater than ramp-up time
+	void onAssemblyDelivered(int station, double time, double creationTime, int reworkCount)
+	{
+		if (time > rampUpTime) {
+			stations[station].delivered++;
+			stations[station].timeInSystem = stations[station].timeInSystem + (time - creationTime);
+			stations[station].timeInSystemDistribution.add(time - creationTime);
+			stations[station].reworkDistribution.add(reworkCount);
+		}
+	}
+
+	void fillResult(ReplicationResult &result) const
+	{
+		result.serverUtilization.resize(servers.size());
+		for (std::size_t k = 0; k < servers.size(); ++k)
+			result.serverUtilization[k] = servers[k].areaAt(endTime) / timeOfInterest;
+		fillStationUtilization(result, firstServer);
+
+		double inSystem = 0;
+		for (std::size_t s = 0; s < stations.size(); ++s)
+			inSystem += stations[s].inSystem.areaAt(endTime);
+
+		result.totalAssembliesCreated = created;
+		result.totalAssembliesDelivered = totalAssembliesDelivered();
+		result.averageTimeInSystem = totalTimeAssembliesInSystem() / timeOfInterest;
+		result.averageNumInSystem = inSystem / timeOfInterest;
+		result.propAssemblyBusy = (assemblyStation >= 0) ? result.stationUtilization[assemblyStation] : 0;
+		result.propReWorkBusy = (reworkStation >= 0) ? result.stationUtilization[reworkStation] : 0;
+		result.warmUpTime = rampUpTime;
+
+		// The distributions of the deliveries of all stations, and the waiting times of each station
+		result.timeInSystemDistribution.clear();
+		result.reworkDistribution.clear();
+		result.waitingTimeDistribution.resize(stations.size());
+		for (std::size_t s = 0; s < stations.size(); ++s) {
+			result.timeInSystemDistribution.merge(stations[s].timeInSystemDistribution);
+			result.reworkDistribution.merge(stations[s].reworkDistribution);
+			result.waitingTimeDistribution[s] = stations[s].waitingTimeDistribution;
+		}
+	}
+
+	// The count of assemblies created, the totals and distributions of each station and the integrals of the servers
+	void save(std::vector<double> &out) const
+	{
+		out.push_back(created);
+		for (std::size_t s = 0; s < stations.size(); ++s) {
+			out.push_back(stations[s].delivered);
+			out.push_back(stations[s].timeInSystem);
+			stations[s].inSystem.save(out);
+			stations[s].timeInSystemDistribution.save(out);
+			stations[s].reworkDistribution.save(out);
+			stations[s].waitingTimeDistribution.save(out);
+		}
+		for (std::size_t k = 0; k < servers.size(); ++k)
+			servers[k].save(out);
+	}
+
+	void restore(const std::vector<double> &in)
+	{
+		created = in[0];
+		std::size_t i = 1;
+		for (std::size_t s = 0; s < stations.size(); ++s) {
+			stations[s].delivered = in[i++];
+			stations[s].timeInSystem = in[i++];
+			i = stations[s].inSystem.restore(in, i);
+			i = stations[s].timeInSystemDistribution.restore(in, i);
+			i = stations[s].reworkDistribution.restore(in, i);
+			i = stations[s].waitingTimeDistribution.restore(in, i);
+		}
+		for (std::size_t k = 0; k < servers.size(); ++k)
+			i = servers[k].restore(in, i);
+	}
+
+	// Take the totals of a station and of its servers, or the count of assemblies created, from the
+	// statistics of the logical process that simulated them
+	void takeStation(const SteadyStateStatistics &from, int station)
+	{
+		stations[station] = from.stations[station];
+		for (int k = firstServer[station]; k < firstServer[station + 1]; ++k)
+			servers[k] = from.servers[k];
+	}
+
+	void takeCreated(const SteadyStateStatistics &from)
+	{
+		created = from.created;
+	}
+
+	// Running totals, for the event trace
+	double totalAssembliesCreated() const { return created; }
+
+	double totalAssembliesDelivered() const
+	{
+		double total = 0;
+		for (std::size_t s = 0; s < stations.size(); ++s)
+			total += stations[s].delivered;
+		return total;
+	}
+
+	double totalTimeAssembliesInSystem() const
+	{
+		double total = 0;
+		for (std::size_t s = 0; s < stations.size(); ++s)
+			total += stations[s].timeInSystem;
+		return total;
+	}
+
+	double cumAssemblies_Time_InSystem(double time) const
+	{
+		double total = 0;
+		for (std::size_t s = 0; s < stations.size(); ++s)
+			total += stations[s].inSystem.areaAt(time);
+		return total;
+	}
+
+private:
+	// Totals of one station
+	struct StationTotals {
+		double delivered;     // Assemblies that left the system from this station
+		double timeInSystem;  // Cumulative time that the assemblies delivered by this station spent in the system
+		TimeIntegral inSystem; // Cumulative sum of (number of assemblies at the station or in its queue * time)
+
+		QuantileSketch timeInSystemDistribution; // Of the assemblies delivered by this station
+		QuantileSketch reworkDistribution;       // Rework loops of the assemblies delivered by this station
+		QuantileSketch waitingTimeDistribution;  // Of the services started at this station
+	};
+
+	double rampUpTime;
+	double endTime;
+	double timeOfInterest;
+	int assemblyStation;
+	int reworkStation;
+
+	double created; // An assembly is created when a kit of parts is merged into a 'pre assembly entity'
+	std::vector<StationTotals> stations;
+	std::vector<int> firstServer; // Servers of station s are servers[firstServer[s]], ..., servers[firstServer[s + 1] - 1]
+	std::vector<TimeIntegral> servers; // Cumulative time that each server has been busy
+};
+
+// Statistics of interest recorded after a warm-up period chosen for each simulation by the MSER-5 rule.
+// Observations are recorded from time 0 in time buckets of params.warmUpBucketWidth minutes. At the end
+// of the simulation, MSER-5 is applied to the average number of assemblies in the system in each bucket,
+// and the statistics of interest are computed from the buckets after the truncation point, with the
+// same estimators as SteadyStateStatistics. The running totals written to the event trace start at time 0.
+class MSERStatistics {
+public:
+	void reset(const ModelParameters &params, const PlantModel &model)
+	{
+		bucketWidth = params.warmUpBucketWidth;
+		endTime = params.endSimulationTime;
+		assemblyStation = model.assemblyStation;
+		reworkStation = model.reworkStation;
+
+		numBuckets = static_cast<std::size_t>(endTime / bucketWidth);
+		if (numBuckets * bucketWidth < endTime)
+			numBuckets++;
+		buckets.assign(numBuckets, Bucket());
+
+		// Column 0 is the number of assemblies in the system, column 1 + k whether server k is busy
+		firstServer.resize(model.stations.size() + 1);
+		firstServer[0] = 0;
+		for (std::size_t s = 0; s < model.stations.size(); ++s)
+			firstServer[s + 1] = firstServer[s] + model.stations[s].servers;
+
+		numColumns = 1 + firstServer.back();
+		areas.assign(numBuckets * numColumns, 0.0);
+		columns.assign(numColumns, Column());
+		numAtStation.assign(model.stations.size(), 0);
+
+		created = 0;
+		delivered = 0;
+		timeInSystem = 0;
+		inSystem.reset(0);
+	}
+
+	// Spread the time since the last change of the number of assemblies in the system over the buckets it covers
+	void onStationChange(int station, double time, int numAt)
+	{
+		double total = columns[0].value + (numAt - numAtStation[station]);
+		setColumn(0, time, total);
+		inSystem.set(time, total);
+		numAtStation[station] = numAt;
+	}
+
+	// Spread the time since the last change of a server over the buckets it covers
+	void onServerChange(int station, int server, double time, bool busy)
+	{
+		setColumn(1 + firstServer[station] + server, time, busy ? 1 : 0);
+	}
+
+	void onAssemblyCreated(double time)
+	{
+		created++;
+		buckets[bucketOf(time)].created++;
+	}
+
+	// Waiting times are not recorded: the truncation point is only known at the end
+	void onServiceStart(int, double, double) {}
+
+	void onAssemblyDelivered(int, double time, double creationTime, int)
+	{
+		delivered++;
+		timeInSystem = timeInSystem + (time - creationTime);
+
+		Bucket &bucket = buckets[bucketOf(time)];
+		bucket.delivered++;
+		bucket.timeInSystem += time - creationTime;
+	}
+
+	void fillResult(ReplicationResult &result) const
+	{
+		// Bring every column up to the end of the simulation
+		std::vector<double> total(areas);
+		for (std::size_t c = 0; c < numColumns; ++c)
+			spread(total, c, columns[c].value, columns[c].last, endTime);
+
+		// Average number of assemblies in the system in each bucket
+		std::vector<double> series(numBuckets);
+		for (std::size_t b = 0; b < numBuckets; ++b)
+			series[b] = total[b * numColumns] / bucketWidth;
+
+		std::size_t first = mserTruncation(series, 5);
+		double warmUpTime = first * bucketWidth;
+		double timeOfInterest = endTime - warmUpTime;
+
+		Bucket sum;
+		std::vector<double> columnSums(numColumns, 0.0);
+		for (std::size_t b = first; b < numBuckets; ++b) {
+			sum.created += buckets[b].created;
+			sum.delivered += buckets[b].delivered;
+			sum.timeInSystem += buckets[b].timeInSystem;
+			for (std::size_t c = 0; c < numColumns; ++c)
+				columnSums[c] += total[b * numColumns + c];
+		}
+
+		result.serverUtilization.resize(numColumns - 1);
+		for (std::size_t k = 0; k + 1 < numColumns; ++k)
+			result.serverUtilization[k] = columnSums[1 + k] / timeOfInterest;
+		fillStationUtilization(result, firstServer);
+
+		result.totalAssembliesCreated = sum.created;
+		result.totalAssembliesDelivered = sum.delivered;
+		result.averageTimeInSystem = sum.timeInSystem / timeOfInterest;
+		result.averageNumInSystem = columnSums[0] / timeOfInterest;
+		result.propAssemblyBusy = (assemblyStation >= 0) ? result.stationUtilization[assemblyStation] : 0;
+		result.propReWorkBusy = (reworkStation >= 0) ? result.stationUtilization[reworkStation] : 0;
+		result.warmUpTime = warmUpTime;
+	}
+
+	// The buckets, the columns and the running totals. A simulation restored with a longer (or shorter)
+	// end of simulation time keeps the buckets that it still has.
+	void save(std::vector<double> &out) const
+	{
+		out.push_back(static_cast<double>(numBuckets));
+		for (std::size_t b = 0; b < numBuckets; ++b) {
+			out.push_back(buckets[b].created);
+			out.push_back(buckets[b].delivered);
+			out.push_back(buckets[b].timeInSystem);
+		}
+		out.insert(out.end(), areas.begin(), areas.end());
+		for (std::size_t c = 0; c < numColumns; ++c) {
+			out.push_back(columns[c].value);
+			out.push_back(columns[c].last);
+		}
+		out.insert(out.end(), numAtStation.begin(), numAtStation.end());
+		out.push_back(created);
+		out.push_back(delivered);
+		out.push_back(timeInSystem);
+		inSystem.save(out);
+	}
+
+	void restore(const std::vector<double> &in)
+	{
+		std::size_t savedBuckets = static_cast<std::size_t>(in[0]);
+		std::size_t common = (savedBuckets < numBuckets) ? savedBuckets : numBuckets;
+		std::size_t i = 1;
+		for (std::size_t b = 0; b < common; ++b) {
+			buckets[b].created = in[i + 3 * b];
+			buckets[b].delivered = in[i + 3 * b + 1];
+			buckets[b].timeInSystem = in[i + 3 * b + 2];
+		}
+		i += 3 * savedBuckets;
+		for (std::size_t a = 0; a < common * numColumns; ++a)
+			areas[a] = in[i + a];
+		i += savedBuckets * numColumns;
+		for (std::size_t c = 0; c < numColumns; ++c) {
+			columns[c].value = in[i++];
+			columns[c].last = in[i++];
+		}
+		for (std::size_t s = 0; s < numAtStation.size(); ++s)
+			numAtStation[s] = static_cast<int>(in[i++]);
+		created = in[i++];
+		delivered = in[i++];
+		timeInSystem = in[i++];
+		inSystem.restore(in, i);
+	}
+
+	// Running totals from time 0, for the event trace
+	double totalAssembliesCreated() const { return created; }
+	double totalAssembliesDelivered() const { return delivered; }
+	double totalTimeAssembliesInSystem() const { return timeInSystem; }
+	double cumAssemblies_Time_InSystem(double time) const { return inSystem.areaAt(time); }
+
+private:
+	// Counts recorded in one time bucket
+	struct Bucket {
+		Bucket() : created(0), delivered(0), timeInSystem(0) {}
+
+		double created;
+		double delivered;
+		double timeInSystem;
+	};
+
+	// A time-weighted quantity: its value since its last change
+	struct Column {
+		Column() : value(0), last(0) {}
+
+		double value;
+		double last;
+	};
+
+	// Index of the bucket holding a given time. Times at the end of the simulation go to the last bucket.
+	std::size_t bucketOf(double time) const
+	{
+		std::size_t b = static_cast<std::size_t>(time / bucketWidth);
+		return (b < numBuckets) ? b : numBuckets - 1;
+	}
+
+	// Add value * time over [from, to) to a column of the buckets it covers
+	void spread(std::vector<double> &target, std::size_t column, double value, double from, double to) const
+	{
+		std::size_t b = bucketOf(from);
+		while (from < to && b < numBuckets) {
+			double bucketEnd = (b + 1) * bucketWidth;
+			double part = ((to < bucketEnd) ? to : bucketEnd) - from;
+			target[b * numColumns + column] += value * part;
+
+			from = bucketEnd;
+			b++;
+		}
+	}
+
+	// A column takes a new value at 'time'
+	void setColumn(std::size_t column, double time, double value)
+	{
+		spread(areas, column, columns[column].value, columns[column].last, time);
+		columns[column].value = value;
+		columns[column].last = time;
+	}
+
+	double bucketWidth;
+	double endTime;
+	int assemblyStation;
+	int reworkStation;
+
+	std::size_t numBuckets;
+	std::vector<Bucket> buckets;
+	std::size_t numColumns;
+	std::vector<double> areas; // Integral of each column over each bucket (numBuckets x numColumns)
+	std::vector<Column> columns;
+	std::vector<int> numAtStation;
+	std::vector<int> firstServer; // Server k of station s is column 1 + firstServer[s] + k
+
+	double created;
+	double delivered;
+	double timeInSystem;
+	TimeIntegral inSystem;
+};
+
+// Statistics of interest recorded after the ramp-up time, as SteadyStateStatistics, and also cut into
+// consecutive batches of simulated time for the batch means method (params.batchMeans). Each batch holds the
+// deliveries and their time in system, and the integrals of the number of assemblies in the system and of
+// the busy servers of each station. At most params.maxBatches batches are kept: when they are all complete,
+// adjacent batches are merged in pairs and the batch width doubles, so the memory used does not grow with
+// the length of the simulation. With params.batchWidth = 0, the batches have a fixed width (the time of
+// interest divided by maxBatches). Otherwise, at the end of the simulation, batches are also merged in pairs
+// while the lag-1 autocorrelation of a statistic exceeds params.maxBatchAutocorrelation, keeping at least
+// minBatchMeans batches. The last batch, cut short by the end of the simulation, is left out.
+class BatchMeansStatistics {
+public:
+	static const std::size_t minBatchMeans = 10;
+
+	void reset(const ModelParameters &params, const PlantModel &model)
+	{
+		steadyState.reset(params, model);
+
+		start = params.rampUpTime;
+		endTime = params.endSimulationTime;
+		maxBatches = (params.maxBatches > 2) ? static_cast<std::size_t>(params.maxBatches) & ~std::size_t(1) : 2;
+		adaptive = params.batchWidth > 0;
+		width = adaptive ? params.batchWidth : params.timeOfInterest() / maxBatches;
+		maxAutocorrelation = params.maxBatchAutocorrelation;
+
+		// Column 0 is the number of deliveries, column 1 their time in system, column 2 the number of
+		// assemblies in the system and column 3 + s the number of busy servers of station s
+		servers.resize(model.stations.size());
+		for (std::size_t s = 0; s < model.stations.size(); ++s)
+			servers[s] = model.stations[s].servers;
+
+		numColumns = 3 + servers.size();
+		batches.assign(maxBatches * numColumns, 0.0);
+		numBatches = 0;
+		current.assign(numColumns, 0.0);
+		columns.assign(numColumns, Column());
+		numAtStation.assign(model.stations.size(), 0);
+		batchStart = start;
+		batchEnd = start + width;
+	}
+
+	void onStationChange(int station, double time, int numAt)
+	{
+		steadyState.onStationChange(station, time, numAt);
+		setColumn(2, time, columns[2].value + (numAt - numAtStation[station]));
+		numAtStation[station] = numAt;
+	}
+
+	void onServerChange(int station, int server, double time, bool busy)
+	{
+		steadyState.onServerChange(station, server, time, busy);
+		setColumn(3 + station, time, columns[3 + station].value + (busy ? 1 : -1));
+	}
+
+	void onAssemblyCreated(double time)
+	{
+		steadyState.onAssemblyCreated(time);
+	}
+
+	void onServiceStart(int station, double time, double arrivalTime)
+	{
+		steadyState.onServiceStart(station, time, arrivalTime);
+	}
+
+	void onAssemblyDelivered(int station, double time, double creationTime, int reworkCount)
+	{
+		steadyState.onAssemblyDelivered(station, time, creationTime, reworkCount);
+		if (time > start) {
+			advance(time);
+			current[0]++;
+			current[1] += time - creationTime;
+		}
+	}
+
+	void fillResult(ReplicationResult &result) const
+	{
+		steadyState.fillResult(result);
+
+		// Complete the batches up to the end of the simulation
+		BatchMeansStatistics complete(*this);
+		complete.advance(complete.endTime + 1e-9 * width);
+
+		if (complete.adaptive) {
+			while (complete.numBatches / 2 >= minBatchMeans && complete.correlated())
+				complete.mergePairs();
+		}
+
+		complete.fillSeries(result.batchMeans);
+	}
+
+	void save(std::vector<double> &out) const
+	{
+		steadyState.save(out);
+		out.push_back(width);
+		out.push_back(static_cast<double>(numBatches));
+		out.insert(out.end(), batches.begin(), batches.begin() + numBatches * numColumns);
+		out.insert(out.end(), current.begin(), current.end());
+		for (std::size_t c = 0; c < numColumns; ++c) {
+			out.push_back(columns[c].value);
+			out.push_back(columns[c].last);
+		}
+		out.insert(out.end(), numAtStation.begin(), numAtStation.end());
+		out.push_back(batchStart);
+		out.push_back(batchEnd);
+	}
+
+	void restore(const std::vector<double> &in)
+	{
+		steadyState.restore(in);
+
+		// The state of the batches follows the state of steadyState
+		std::vector<double> own;
+		steadyState.save(own);
+		std::size_t i = own.size();
+
+		width = in[i++];
+		numBatches = static_cast<std::size_t>(in[i++]);
+		for (std::size_t a = 0; a < numBatches * numColumns; ++a)
+			batches[a] = in[i++];
+		for (std::size_t c = 0; c < numColumns; ++c)
+			current[c] = in[i++];
+		for (std::size_t c = 0; c < numColumns; ++c) {
+			columns[c].value = in[i++];
+			columns[c].last = in[i++];
+		}
+		for (std::size_t s = 0; s < numAtStation.size(); ++s)
+			numAtStation[s] = static_cast<int>(in[i++]);
+		batchStart = in[i++];
+		batchEnd = in[i++];
+	}
+
+	// Running totals, for the event trace
+	double totalAssembliesCreated() const { return steadyState.totalAssembliesCreated(); }
+	double totalAssembliesDelivered() const { return steadyState.totalAssembliesDelivered(); }
+	double totalTimeAssembliesInSystem() const { return steadyState.totalTimeAssembliesInSystem(); }
+	double cumAssemblies_Time_InSystem(double time) const { return steadyState.cumAssemblies_Time_InSystem(time); }
+
+private:
+	// A time-weighted quantity: its value since its last change
+	struct Column {
+		Column() : value(0), last(0) {}
+
+		double value;
+		double last;
+	};
+
+	// Add the time-weighted value of a column up to 'time' to the current batch
+	void integrate(std::size_t column, double time)
+	{
+		double from = (columns[column].last > batchStart) ? columns[column].last : batchStart;
+		if (time > from)
+			current[column] += columns[column].value * (time - from);
+		columns[column].last = time;
+	}
+
+	// A column takes a new value at 'time'
+	void setColumn(std::size_t column, double time, double value)
+	{
+		advance(time);
+		integrate(column, time);
+		columns[column].value = value;
+	}
+
+	// Complete the batches that end at or before 'time'
+	void advance(double time)
+	{
+		while (time >= batchEnd) {
+			for (std::size_t c = 2; c < numColumns; ++c)
+				integrate(c, batchEnd);
+
+			std::copy(current.begin(), current.end(), batches.begin() + numBatches * numColumns);
+			std::fill(current.begin(), current.end(), 0.0);
+			numBatches++;
+			batchStart = batchEnd;
+
+			// Fixed batches end with the simulation: nothing more is recorded
+			if (numBatches == maxBatches && !adaptive) {
+				batchEnd = std::numeric_limits<double>::infinity();
+				return;
+			}
+			if (numBatches == maxBatches)
+				mergePairs();
+
+			batchEnd = batchStart + width;
+		}
+	}
+
+	// Merge the batches in pairs (an odd last batch is dropped) and double the batch width
+	void mergePairs()
+	{
+		std::size_t pairs = numBatches / 2;
+		for (std::size_t b = 0; b < pairs; ++b) {
+			for (std::size_t c = 0; c < numColumns; ++c)
+				batches[b * numColumns + c] = batches[2 * b * numColumns + c] + batches[(2 * b + 1) * numColumns + c];
+		}
+		numBatches = pairs;
+		width *= 2;
+	}
+
+	// Batch means of each statistic
+	void fillSeries(BatchMeansSeries &series) const
+	{
+		series.batchWidth = width;
+		series.means.assign(numColumns - 1, std::vector<double>(numBatches));
+		for (std::size_t b = 0; b < numBatches; ++b) {
+			const double *batch = &batches[b * numColumns];
+			series.means[0][b] = (batch[0] > 0) ? batch[1] / batch[0] : std::numeric_limits<double>::quiet_NaN();
+			series.means[1][b] = batch[2] / width;
+			for (std::size_t s = 0; s < servers.size(); ++s)
+				series.means[2 + s][b] = batch[3 + s] / (width * servers[s]);
+		}
+	}
+
+	// Whether the batch means of any statistic are too correlated to be taken as independent
+	bool correlated() const
+	{
+		BatchMeansSeries series;
+		fillSeries(series);
+		for (std::size_t m = 0; m < series.means.size(); ++m) {
+			if (batchMeansInterval(series.means[m], 0.95).lag1Autocorrelation > maxAutocorrelation)
+				return true;
+		}
+		return false;
+	}
+
+	SteadyStateStatistics steadyState;
+
+	double start;
+	double endTime;
+	std::size_t maxBatches;
+	bool adaptive;
+	double width;
+	double maxAutocorrelation;
+	std::vector<int> servers; // Number of servers of each station
+
+	std::size_t numColumns;
+	std::vector<double> batches; // Sums of each column over each complete batch (maxBatches x numColumns)
+	std::size_t numBatches;
+	std::vector<double> current; // Sums of each column over the current batch
+	std::vector<Column> columns;
+	std::vector<int> numAtStation;
+	double batchStart;
+	double batchEnd;
+};
+
+// No statistics are recorded. Used when only the state of the system matters (e.g. to measure
+// the speed of the engine itself).
+class NoStatistics {
+public:
+	void reset(const ModelParameters &, const PlantModel &) {}
+	void onStationChange(int, double, int) {}
+	void onServerChange(int, int, double, bool) {}
+	void onAssemblyCreated(double) {}
+	void onServiceStart(int, double, double) {}
+	void onAssemblyDelivered(int, double, double, int) {}
+	void save(std::vector<double> &) const {}
+	void restore(const std::vector<double> &) {}
+
+	void fillResult(ReplicationResult &result) const
+	{
+		result.totalAssembliesCreated = 0;
+		result.totalAssembliesDelivered = 0;
+		result.averageTimeInSystem = 0;
+		result.averageNumInSystem = 0;
+		result.propAssemblyBusy = 0;
+		result.propReWorkBusy = 0;
+		result.warmUpTime = 0;
+		result.stationUtilization.clear();
+		result.serverUtilization.clear();
+		result.timeInSystemDistribution.clear();
+		result.reworkDistribution.clear();
+		result.waitingTimeDistribution.clear();
+	}
+
+	double totalAssembliesCreated() const { return 0; }
+	double totalAssembliesDelivered() const { return 0; }
+	double totalTimeAssembliesInSystem() const { return 0; }
+	double cumAssemblies_Time_InSystem(double) const { return 0; }
+};
+
+#endif /* STATISTICS_POLICIES_H */
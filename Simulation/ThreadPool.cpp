@@ -0,0 +1,144 @@
+// Definition of class ThreadPool.
+
+// Include header file for class ThreadPool
+#include "ThreadPool.h"
+
+// Index of the worker running on the current thread (-1 outside the pool), and the pool it belongs to
+static thread_local int currentWorker = -1;
+static thread_local const ThreadPool *currentPool = 0;
+
+// Number of threads used for a requested number of threads (0 means one per core)
+unsigned ThreadPool::resolveThreadCount(unsigned numThreads)
+{
+	if (numThreads > 0)
+		return numThreads;
+
+	unsigned cores = std::thread::hardware_concurrency();
+	return (cores > 0) ? cores : 1;
+}
+
+// Constructor
+ThreadPool::ThreadPool(unsigned numThreads) : queued(0), pending(0), stopping(false)
+{
+	unsigned n = resolveThreadCount(numThreads);
+
+	for (unsigned i = 0; i < n; ++i)
+		workers.push_back(std::unique_ptr<Worker>(new Worker()));
+
+	for (unsigned i = 0; i < n; ++i)
+		threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+}
+
+// Destructor
+ThreadPool::~ThreadPool()
+{
+	wait();
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+}
+
+// Submit a task to be run by one of the workers
+void ThreadPool::submit(Task task)
+{
+	pending++;
+	if (currentPool == this && currentWorker >= 0) {
+		Worker &worker = *workers[currentWorker];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(task);
+	}
+	else {
+		std::lock_guard<std::mutex> lock(submittedMutex);
+		submitted.push_back(task);
+	}
+
+	// Count the task under the sleep mutex so that no worker misses it
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		queued++;
+	}
+	wake.notify_one();
+}
+
+// Block until every submitted task has finished
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(sleepMutex);
+	finished.wait(lock, [this] { return pending == 0; });
+}
+
+// Take a task from the back of a worker's own queue
+bool ThreadPool::tryPop(unsigned index, Task &task)
+{
+	Worker &worker = *workers[index];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty())
+		return false;
+
+	task = worker.tasks.back();
+	worker.tasks.pop_back();
+	return true;
+}
+
+// Take the first task of the shared queue
+bool ThreadPool::tryPopSubmitted(Task &task)
+{
+	std::lock_guard<std::mutex> lock(submittedMutex);
+	if (submitted.empty())
+		return false;
+
+	task = submitted.front();
+	submitted.pop_front();
+	return true;
+}
+
+// Steal a task from the front of the queue of another worker
+bool ThreadPool::trySteal(unsigned index, Task &task)
+{
+	unsigned n = size();
+	for (unsigned k = 1; k < n; ++k) {
+		Worker &victim = *workers[(index + k) % n];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Main loop of each worker thread
+void ThreadPool::workerLoop(unsigned index)
+{
+	currentWorker = static_cast<int>(index);
+	currentPool = this;
+
+	while (1) {
+		Task task;
+		if (tryPop(index, task) || tryPopSubmitted(task) || trySteal(index, task)) {
+			queued--;
+			task();
+
+			// If this was the last pending task, wake up whoever is waiting
+			if (--pending == 0) {
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				finished.notify_all();
+			}
+			continue;
+		}
+
+		// Nothing to do: sleep until a task is submitted or the pool stops
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this] { return stopping || queued > 0; });
+		if (stopping && queued == 0)
+			return;
+	}
+}
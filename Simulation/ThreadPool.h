@@ -0,0 +1,71 @@
+// Header file for class ThreadPool
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+// A pool of worker threads with work stealing. Tasks submitted from outside the pool go to a shared
+// queue and are started in the order they were submitted, so that results consumed in that order
+// (see ReplicationRunner) do not wait for the last ones. Tasks submitted by a running task go to the
+// double-ended queue of the worker running it. A worker takes tasks from the back of its own queue,
+// then from the shared queue, and when both are empty it steals from the front of the queues of the
+// other workers.
+class ThreadPool {
+public:
+	typedef std::function<void()> Task;
+
+	// Constructor. A number of threads of 0 means one thread per core.
+	explicit ThreadPool(unsigned numThreads = 0);
+
+	// Destructor. Waits for all submitted tasks to finish.
+	~ThreadPool();
+
+	// Submit a task to be run by one of the workers
+	void submit(Task);
+
+	// Block until every submitted task has finished
+	void wait();
+
+	// Number of worker threads
+	unsigned size() const { return static_cast<unsigned>(threads.size()); }
+
+	// Number of threads used for a requested number of threads (0 means one per core)
+	static unsigned resolveThreadCount(unsigned);
+
+private:
+	struct Worker {
+		std::deque<Task> tasks;
+		std::mutex mutex;
+	};
+
+	void workerLoop(unsigned);
+
+	// Take a task from the back of a worker's own queue or from the shared queue, or steal one from the
+	// other workers
+	bool tryPop(unsigned, Task &);
+	bool tryPopSubmitted(Task &);
+	bool trySteal(unsigned, Task &);
+
+	std::vector<std::unique_ptr<Worker> > workers;
+	std::deque<Task> submitted; // Tasks submitted from outside the pool, in order
+	std::mutex submittedMutex;
+	std::vector<std::thread> threads;
+
+	std::mutex sleepMutex;
+	std::condition_variable wake;     // Signalled when a task is submitted or the pool stops
+	std::condition_variable finished; // Signalled when the last pending task finishes
+
+	std::atomic<long> queued;       // Tasks waiting in the queues
+	std::atomic<long> pending;      // Tasks submitted but not finished
+	bool stopping;
+};
+
+#endif /* THREAD_POOL_H */
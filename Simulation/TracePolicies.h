@@ -0,0 +1,160 @@
+// Header file for the trace policies of the simulation engine
+#ifndef TRACE_POLICIES_H
+#define TRACE_POLICIES_H
+
+#include <iostream>
+#include <sstream>
+#include <iomanip> // std::setprecision
+#include <string>
+
+#include "Event.h"
+#include "PlantModel.h"
+#include "Simulation.h"
+
+// Number of stations whose state is written to the event trace (the first stations of the model)
+static const int maxTraceStations = 5;
+
+// What is written to the event trace after an event: the state of the system and the statistics
+// of interest. Simulation_Runs.csv holds one of these per row.
+struct TraceRow {
+	double simulationTime;
+	Event event;
+	int location;    // Part type of an arrival, or station of a departure or downtime event
+	int numStations; // Number of entries of numAtStation in use
+	int numAtStation[maxTraceStations];
+	double totalAssembliesCreated;
+	double totalAssembliesDelivered;
+	double totalTimeAssembliesInSystem;
+	double cumAssemblies_Time_InSystem;
+	double nextID;
+};
+
+// Description of the event of a row, naming its part type or station (e.g. "Departure: Coating Station")
+inline std::string describeEvent(const TraceRow &row, const PlantModel &model)
+{
+	EventType type = row.event.getEventType();
+	if (type == EVENT_ARRIVAL && row.location >= 0 && row.location < static_cast<int>(model.parts.size()))
+		return "Arrival: " + model.parts[row.location].name;
+	if (type == EVENT_DEPARTURE && row.location >= 0 && row.location < static_cast<int>(model.stations.size()))
+		return "Departure: " + model.stations[row.location].name + " Station";
+	if ((type == EVENT_FAILURE || type == EVENT_REPAIR || type == EVENT_SHIFT_END || type == EVENT_SHIFT_START) &&
+		row.location >= 0 && row.location < static_cast<int>(model.stations.size()))
+		return row.event.eventTypeToString() + ": " + model.stations[row.location].name + " Station";
+
+	return row.event.eventTypeToString();
+}
+
+// Place a header line and the column names in the CSV file before each simulation
+inline void writeTraceHeader(std::ostream &Simulation_Runs, int replication, const PlantModel &model)
+{
+	Simulation_Runs << "Simulation Number: " << replication + 1 << std::endl;
+	Simulation_Runs << "Simulation Time, Event Type, ";
+	for (std::size_t s = 0; s < model.stations.size() && s < static_cast<std::size_t>(maxTraceStations); ++s)
+		Simulation_Runs << " Pre " << model.stations[s].name << ",";
+	Simulation_Runs << " Assemblies Created, Assemblies Delivered,"
+		"Total Assembly Time in System" << "," << "cumAssemblies_Time_InSystem" << "," << "Event ID" << "," << "next ID" << std::endl;
+}
+
+// Write one row of simulation run output to the CSV file
+inline void writeTraceRow(std::ostream &Simulation_Runs, const TraceRow &row, const PlantModel &model, int precision = 4)
+{
+	Simulation_Runs << std::setprecision(precision) << row.simulationTime << "," << describeEvent(row, model) << ",";
+	for (int s = 0; s < row.numStations; ++s)
+		Simulation_Runs << row.numAtStation[s] << ",";
+	Simulation_Runs << row.totalAssembliesCreated << "," << row.totalAssembliesDelivered << "," << row.totalTimeAssembliesInSystem << "," <<
+		row.cumAssemblies_Time_InSystem << "," << row.event.getPartID() << "," << row.nextID << '\n';
+}
+
+// A trace policy decides what a simulation writes while it runs. The engine only builds a TraceRow
+// inside "if (Trace::recordsEvents)" and "if (Trace::recordsSummary)", and only prints the FEL inside
+// "if (Trace::printsEventList)", so with NoTrace all of the tracing code is compiled out.
+//
+// The binary trace (BinaryTrace) is in BinaryTrace.h.
+//
+// A trace policy provides:
+//   static const bool recordsEvents, recordsSummary, printsEventList;
+//   void beginReplication(int replication, const PlantModel &);  // The model outlives the replication
+//   void recordEvent(const TraceRow &);     // After every event
+//   void endReplication(const TraceRow &);  // After the end of simulation event
+//   std::ostream &console();                // Console output (FEL dumps and error messages)
+//   void moveOutput(ReplicationOutput &);   // Hand the trace and console output to the caller
+
+// Nothing is written. Error messages go to the standard error stream.
+class NoTrace {
+public:
+	static const bool recordsEvents = false;
+	static const bool recordsSummary = false;
+	static const bool printsEventList = false;
+
+	void beginReplication(int, const PlantModel &) {}
+	void recordEvent(const TraceRow &) {}
+	void endReplication(const TraceRow &) {}
+	std::ostream &console() { return std::cerr; }
+	void moveOutput(ReplicationOutput &) {}
+};
+
+// Base class of the policies that write Simulation_Runs.csv
+class CsvTrace {
+public:
+	CsvTrace() : model(0) {}
+
+	// A copy starts with an empty trace
+	CsvTrace(const CsvTrace &) : model(0) {}
+
+	std::ostream &console() { return consoleStream; }
+
+	void moveOutput(ReplicationOutput &output)
+	{
+		output.eventTrace = Simulation_Runs.str();
+		output.consoleOutput = consoleStream.str();
+		Simulation_Runs.str("");
+		consoleStream.str("");
+	}
+
+protected:
+	void writeHeader(int replication, const PlantModel &plantModel)
+	{
+		model = &plantModel;
+		writeTraceHeader(Simulation_Runs, replication, plantModel);
+	}
+	void writeRow(const TraceRow &row) { writeTraceRow(Simulation_Runs, row, *model); }
+
+	// At the end of each simulation, add a blank line to the CSV file and separators to the console output
+	void writeFooter()
+	{
+		Simulation_Runs << std::endl;
+		consoleStream << "----------------------" << std::endl;
+		consoleStream << "------------------------" << std::endl;
+	}
+
+	std::ostringstream Simulation_Runs;
+	std::ostringstream consoleStream;
+	const PlantModel *model; // Names of the part types and stations of the replication being written
+};
+
+// Only the final state of each simulation is written to Simulation_Runs.csv
+class SummaryTrace : public CsvTrace {
+public:
+	static const bool recordsEvents = false;
+	static const bool recordsSummary = true;
+	static const bool printsEventList = false;
+
+	void beginReplication(int replication, const PlantModel &plantModel) { writeHeader(replication, plantModel); }
+	void recordEvent(const TraceRow &) {}
+	void endReplication(const TraceRow &row) { writeRow(row); writeFooter(); }
+};
+
+// One row per event is written to Simulation_Runs.csv, and the FEL is printed to the console
+// output after every event (for debugging purposes).
+class FullTrace : public CsvTrace {
+public:
+	static const bool recordsEvents = true;
+	static const bool recordsSummary = false;
+	static const bool printsEventList = true;
+
+	void beginReplication(int replication, const PlantModel &plantModel) { writeHeader(replication, plantModel); }
+	void recordEvent(const TraceRow &row) { writeRow(row); }
+	void endReplication(const TraceRow &) { writeFooter(); }
+};
+
+#endif /* TRACE_POLICIES_H */
@@ -0,0 +1,133 @@
+// TraceToCsv - converts a binary event trace (Simulation_Runs.bin) written with TRACE_BINARY
+// into the CSV layout of Simulation_Runs.csv.
+//
+// Usage: TraceToCsv [input.bin] [output.csv] [--precision=N] [--model=plant.txt]
+// The defaults are Simulation_Runs.bin, Simulation_Runs.csv and a precision of 4 significant
+// digits (the precision of the CSV trace written by the simulation). The part types and stations
+// are named after the reference plant, or after the plant model file the trace was written with.
+//
+// The input file is memory-mapped and read in place. Blocks of simulations that ran in parallel
+// are put back in order of simulation number.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstring> // std::memcmp, std::memcpy
+#include <cstdlib> // std::atoi
+
+#include "BinaryTrace.h"
+#include "MappedFile.h"
+#include "PlantModel.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	string inputPath = "Simulation_Runs.bin";
+	string outputPath = "Simulation_Runs.csv";
+	int precision = 4;
+	string modelPath;
+
+	// Read the command line
+	int positional = 0;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg.compare(0, 12, "--precision=") == 0)
+			precision = atoi(arg.c_str() + 12);
+		else if (arg.compare(0, 8, "--model=") == 0)
+			modelPath = arg.substr(8);
+		else if (positional == 0) {
+			inputPath = arg;
+			positional++;
+		}
+		else if (positional == 1) {
+			outputPath = arg;
+			positional++;
+		}
+		else {
+			cout << "Usage: TraceToCsv [input.bin] [output.csv] [--precision=N] [--model=plant.txt]" << endl;
+			return 1;
+		}
+	}
+
+	// Names of the part types and stations
+	PlantModel model = referencePlant(ModelParameters());
+	string error;
+	if (!modelPath.empty() && !loadPlantModel(modelPath, model, error)) {
+		cout << "Error, " << error << endl;
+		return 1;
+	}
+
+	MappedFile input;
+	if (!input.open(inputPath)) {
+		cout << "Error, cannot open " << inputPath << endl;
+		return 1;
+	}
+
+	// Check the file header
+	TraceFileHeader header;
+	if (input.size() < sizeof(header)) {
+		cout << "Error, " << inputPath << " is not a trace file" << endl;
+		return 1;
+	}
+	memcpy(&header, input.data(), sizeof(header));
+
+	if (memcmp(header.magic, "DESTRACE", 8) != 0 || header.version != traceFileVersion) {
+		cout << "Error, " << inputPath << " is not a trace file of this version" << endl;
+		return 1;
+	}
+	if (header.byteOrderMark != traceByteOrderMark || header.recordSize != sizeof(TraceRecord)) {
+		cout << "Error, " << inputPath << " was written on a machine with a different byte order or record layout" << endl;
+		return 1;
+	}
+
+	// Find the blocks of each simulation
+	map<uint32_t, vector<size_t> > blocksOfReplication;
+	size_t offset = sizeof(header);
+	while (offset + sizeof(TraceBlockHeader) <= input.size()) {
+		TraceBlockHeader block;
+		memcpy(&block, input.data() + offset, sizeof(block));
+
+		size_t end = offset + sizeof(block) + static_cast<size_t>(block.recordCount) * sizeof(TraceRecord);
+		if (end > input.size()) {
+			cout << "Warning, " << inputPath << " ends in the middle of a block" << endl;
+			break;
+		}
+
+		blocksOfReplication[block.replication].push_back(offset);
+		offset = end;
+	}
+
+	ofstream output(outputPath.c_str(), ios::out);
+	if (!output) {
+		cout << "Error, cannot create " << outputPath << endl;
+		return 1;
+	}
+
+	// Write the simulations in order
+	uint64_t rows = 0;
+	for (map<uint32_t, vector<size_t> >::iterator it = blocksOfReplication.begin(); it != blocksOfReplication.end(); ++it) {
+		writeTraceHeader(output, static_cast<int>(it->first), model);
+
+		for (size_t b = 0; b < it->second.size(); ++b) {
+			const char *blockStart = input.data() + it->second[b];
+			TraceBlockHeader block;
+			memcpy(&block, blockStart, sizeof(block));
+
+			const TraceRecord *records = reinterpret_cast<const TraceRecord *>(blockStart + sizeof(block));
+			for (uint32_t r = 0; r < block.recordCount; ++r)
+				writeTraceRow(output, fromTraceRecord(records[r]), model, precision);
+
+			rows += block.recordCount;
+		}
+
+		//At the end of each simulation, add a blank line to the CSV file.
+		output << endl;
+	}
+
+	cout << "Wrote " << rows << " rows of " << blocksOfReplication.size() << " simulations to " << outputPath << endl;
+
+	return 0;
+}